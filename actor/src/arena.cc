@@ -0,0 +1,79 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace kin {
+
+
+constexpr std::size_t Arena::kDefaultBlockSize;
+
+Arena::Arena(const std::size_t block_size):
+        block_size_(block_size), block_(0), offset_(0),
+        bytes_allocated_(0), n_allocations_(0), capacity_(0), n_resets_(0) {}
+
+Arena::~Arena() {
+    DestroyObjects();
+}
+
+void* Arena::Allocate(const std::size_t size, const std::size_t alignment) {
+    // Find the first block, starting with the current one, in which
+    // the allocation fits. Blocks following the current one are
+    // unused, having been kept from before the last reset.
+    for (; block_ < blocks_.size(); ++block_, offset_ = 0) {
+        const Block &block = blocks_[block_];
+        const std::uintptr_t base =
+            reinterpret_cast<std::uintptr_t>(block.memory.get());
+        const std::uintptr_t start =
+            (base + offset_ + alignment - 1) / alignment * alignment;
+        if (start + size <= base + block.size) {
+            offset_ = start + size - base;
+            bytes_allocated_ += size;
+            ++n_allocations_;
+            return reinterpret_cast<void*>(start);
+        }
+    }
+    // No block has room; add one large enough to hold the allocation
+    // at any alignment, and allocate from it.
+    const std::size_t new_size = std::max(block_size_, size + alignment);
+    blocks_.push_back({std::unique_ptr<char[]>(new char[new_size]), new_size});
+    capacity_ += new_size;
+    block_ = blocks_.size() - 1;
+    offset_ = 0;
+    return Allocate(size, alignment);
+}
+
+void Arena::Reset() {
+    DestroyObjects();
+    block_ = 0;
+    offset_ = 0;
+    bytes_allocated_ = 0;
+    n_allocations_ = 0;
+    ++n_resets_;
+}
+
+void Arena::DestroyObjects() {
+    for (auto it = finalizers_.rbegin(); it != finalizers_.rend(); ++it) {
+        it->destroy(it->object);
+    }
+    finalizers_.clear();
+}
+
+
+}  // namespace kin
@@ -0,0 +1,158 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_ARENA_H_
+#define ACTOR_SRC_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace kin {
+
+
+/**
+ * Monotonic allocator, from which memory is taken in order from large
+ * blocks, and which is only ever released all at once.
+ *
+ * Objects made with Create() that are not trivially destructible are
+ * destroyed, in reverse order of creation, when the arena is Reset()
+ * or destroyed; Reset() is otherwise constant time. Blocks are kept
+ * when the arena is reset, so an arena which is repeatedly filled and
+ * reset stops allocating from the heap once it has grown large enough.
+ */
+class Arena {
+ public:
+    static constexpr std::size_t kDefaultBlockSize = 16384;
+
+    explicit Arena(std::size_t block_size = kDefaultBlockSize);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /** Gets memory of passed size and alignment. */
+    void* Allocate(std::size_t size, std::size_t alignment);
+
+    /** Constructs object of type T in memory from the arena. */
+    template <typename T, typename... Args>
+    T* Create(Args&&... args) {
+        T *object = new (Allocate(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value) {
+            finalizers_.push_back({object, &Destroy<T>});
+        }
+        return object;
+    }
+
+    /**
+     * Destroys all objects made with Create(), and makes all memory
+     * of the arena available for reuse.
+     */
+    void Reset();
+
+    // getters
+    /** Bytes allocated since the last reset, excluding padding. */
+    std::size_t bytes_allocated() const { return bytes_allocated_; }
+    /** Number of allocations since the last reset. */
+    std::size_t n_allocations() const { return n_allocations_; }
+    /** Total size of blocks held by the arena. */
+    std::size_t capacity() const { return capacity_; }
+    std::size_t n_blocks() const { return blocks_.size(); }
+    std::size_t n_resets() const { return n_resets_; }
+
+ private:
+    struct Block {
+        std::unique_ptr<char[]> memory;
+        std::size_t size;
+    };
+
+    struct Finalizer {
+        void *object;
+        void (*destroy)(void*);
+    };
+
+    const std::size_t block_size_;
+    std::vector<Block> blocks_;
+    std::size_t block_;   // Index of block being allocated from.
+    std::size_t offset_;  // Offset of unused memory in block.
+    std::vector<Finalizer> finalizers_;
+    std::size_t bytes_allocated_;
+    std::size_t n_allocations_;
+    std::size_t capacity_;
+    std::size_t n_resets_;
+
+    template <typename T>
+    static void Destroy(void *object) { static_cast<T*>(object)->~T(); }
+
+    /** Runs finalizers in reverse order of creation. */
+    void DestroyObjects();
+};
+
+
+/**
+ * Standard allocator which takes memory from an Arena, so that
+ * containers may be placed in one.
+ *
+ * Deallocation does nothing; memory is reclaimed when the arena is
+ * reset. An allocator without an arena uses the heap instead.
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+    using value_type = T;
+
+    ArenaAllocator(Arena *arena = nullptr): arena_(arena) {}  // NOLINT
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other):  // NOLINT
+        arena_(other.arena()) {}
+
+    T* allocate(std::size_t n) {
+        if (arena_ == nullptr) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, std::size_t) {
+        if (arena_ == nullptr) {
+            ::operator delete(p);
+        }
+    }
+
+    Arena* arena() const { return arena_; }
+
+ private:
+    Arena *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+    return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+    return lhs.arena() != rhs.arena();
+}
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_ARENA_H_
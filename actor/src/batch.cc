@@ -0,0 +1,275 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "const.h"
+
+namespace kin {
+
+
+// Number of orbits processed together by each pass of the kernel.
+// Small enough that the per-lane scratch arrays stay in L1.
+static constexpr std::size_t kBatchLanes = 64;
+// Laguerre corrections applied to every lane. From the starter
+// chosen below, four reach the precision of UniversalPropagator for
+// 0 <= e <= 3 and 1e-4 to 1e4 time units (checked offline over
+// randomized states, including e within 1e-3 of 1); one more is
+// applied as margin.
+static constexpr int kBatchUniversalIterations = 5;
+// Stumpff functions are found from their series at z / 4^n, then
+// brought back to z by n applications of the quadrupling formulas.
+// With n = 6 the result is accurate to ~1e-13 for |z| < 400; that is,
+// for any elliptic orbit, and for hyperbolic orbits until the
+// hyperbolic anomaly has changed by 20.
+static constexpr int kStumpffQuarterings = 6;
+static constexpr double kStumpffScale = 1. / 4096.;  // 4^-6
+// Order used by Laguerre's method; as in UniversalPropagator.
+static constexpr double kLaguerreOrder = 5.;
+
+
+/**
+ * Evaluates the Stumpff functions c2 and c3 at z without branching on
+ * the sign or magnitude of z.
+ */
+static inline void BatchStumpff(const double z, double *c2, double *c3) {
+    const double x = z * kStumpffScale;
+    double s2 = 1. / 2. - x * (1. / 24. - x * (1. / 720. -
+        x * (1. / 40320. - x / 3628800.)));
+    double s3 = 1. / 6. - x * (1. / 120. - x * (1. / 5040. -
+        x * (1. / 362880. - x / 39916800.)));
+    double s0 = 1. - x * s2;
+    double s1 = 1. - x * s3;
+    for (int i = 0; i < kStumpffQuarterings; ++i) {
+        const double next_s3 = (s2 + s0 * s3) / 4.;
+        s2 = s1 * s1 / 2.;
+        s1 = s0 * s1;
+        s0 = 2. * s0 * s0 - 1.;
+        s3 = next_s3;
+    }
+    *c2 = s2;
+    *c3 = s3;
+}
+
+/**
+ * Gets the error in sqrt(u) * time of passed estimate of chi, which
+ * is used to choose between starting estimates. Non-finite errors are
+ * returned as the largest double, so that the estimate is never
+ * preferred.
+ */
+static inline double TimeResidual(const double sqrt_u, const double r_norm,
+        const double sigma, const double alpha, const double dt,
+        const double chi) {
+    const double z = alpha * chi * chi;
+    double c2, c3;
+    BatchStumpff(z, &c2, &c3);
+    const double k = 1. - alpha * r_norm;
+    const double residual = std::fabs(sigma * chi * chi * c2 +
+        k * chi * chi * chi * c3 + r_norm * chi - sqrt_u * dt);
+    return std::isfinite(residual) ?
+        residual : std::numeric_limits<double>::max();
+}
+
+/**
+ * Finds the root of y^3 + p y + q = 0 for p >= 0.
+ */
+static inline double CubicRoot(const double p, const double q) {
+    const double disc = std::sqrt(std::fabs(q * q / 4. + p * p * p / 27.));
+    return std::cbrt(-q / 2. + disc) + std::cbrt(-q / 2. - disc);
+}
+
+
+std::size_t OrbitBatch::Add(const Orbit &orbit, const double t0) {
+    const double u = orbit.gravitational_parameter();
+    const KinematicData state = orbit.kinematic_data();
+    const double sqrt_u = std::sqrt(u);
+    const double r_norm = state.r.norm();
+    const double sigma = state.r.dot(state.v) / sqrt_u;
+    const double alpha = 2. / r_norm - state.v.squaredNorm() / u;
+    const double root_alpha = std::sqrt(std::fabs(alpha));
+    // e cos(E0) and e sin(E0) (or e cosh(H0), e sinh(H0)) follow
+    // directly from the state vector.
+    const double e_cos = 1. - r_norm * alpha;
+    const double e_sin = sigma * root_alpha;
+    double e, anomaly0, m0, period;
+    if (alpha > 0.) {
+        e = std::hypot(e_cos, e_sin);
+        anomaly0 = std::atan2(e_sin, e_cos);
+        m0 = anomaly0 - e_sin;
+        period = TAU / (sqrt_u * alpha * root_alpha);
+    } else {
+        e = std::sqrt(std::fmax(0., e_cos * e_cos - e_sin * e_sin));
+        anomaly0 = e > 0. ? std::asinh(e_sin / e) : 0.;
+        m0 = e_sin - anomaly0;
+        period = 0.;
+    }
+    t0_.push_back(t0);
+    sqrt_u_.push_back(sqrt_u);
+    r_norm_.push_back(r_norm);
+    sigma_.push_back(sigma);
+    alpha_.push_back(alpha);
+    root_alpha_.push_back(root_alpha);
+    e_.push_back(e);
+    anomaly0_.push_back(anomaly0);
+    m0_.push_back(m0);
+    n_.push_back(sqrt_u * std::fabs(alpha) * root_alpha);
+    period_.push_back(period);
+    inv_period_.push_back(period > 0. ? 1. / period : 0.);
+    rx_.push_back(state.r.x());
+    ry_.push_back(state.r.y());
+    rz_.push_back(state.r.z());
+    vx_.push_back(state.v.x());
+    vy_.push_back(state.v.y());
+    vz_.push_back(state.v.z());
+    return t0_.size() - 1;
+}
+
+void OrbitBatch::Reserve(const std::size_t capacity) {
+    for (std::vector<double> *array : arrays()) {
+        array->reserve(capacity);
+    }
+}
+
+void OrbitBatch::Clear() {
+    for (std::vector<double> *array : arrays()) {
+        array->clear();
+    }
+}
+
+void OrbitBatch::Predict(
+        const double t, std::vector<Vector> *r, std::vector<Vector> *v) const {
+    const std::size_t n_orbits = size();
+    r->resize(n_orbits);
+    v->resize(n_orbits);
+    // Scratch arrays for a single chunk of lanes.
+    double dt[kBatchLanes];
+    double chi[kBatchLanes];
+
+    for (std::size_t start = 0; start < n_orbits; start += kBatchLanes) {
+        const std::size_t n = std::min(kBatchLanes, n_orbits - start);
+        const double * const sqrt_u = &sqrt_u_[start];
+        const double * const r_norm = &r_norm_[start];
+        const double * const sigma = &sigma_[start];
+        const double * const alpha = &alpha_[start];
+
+        // Remove whole periods from bound orbits (inv_period is 0 for
+        // the others), then start from whichever of several estimates
+        // of chi solves the equation most closely:
+        //  - the root of the parabolic (alpha = 0) form of the
+        //    equation; accurate whenever |alpha chi^2| is small,
+        //  - Danby's guess for the eccentric anomaly, or an asinh
+        //    guess for the hyperbolic anomaly, which are accurate far
+        //    from periapsis,
+        //  - the root of the cubic expansion of the hyperbolic Kepler
+        //    equation, accurate near periapsis of near-parabolic
+        //    orbits, and
+        //  - a linear step from epoch, accurate for short times.
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t j = start + i;
+            const double time = t - t0_[j];
+            dt[i] = time - period_[j] * std::round(time * inv_period_[j]);
+            const bool bound = alpha[i] > 0.;
+            const double e = e_[j];
+            const double m = m0_[j] + n_[j] * dt[i];
+
+            const double parabolic_chi = CubicRoot(
+                3. * (2. * r_norm[i] - sigma[i] * sigma[i]),
+                2. * sigma[i] * sigma[i] * sigma[i] -
+                    6. * r_norm[i] * sigma[i] - 6. * sqrt_u[i] * dt[i]) -
+                sigma[i];
+            const double anomaly = bound ?
+                m + std::copysign(0.85 * e, std::sin(m)) :
+                std::asinh(m / e);
+            const double cubic_anomaly =
+                CubicRoot(6. * std::fabs(e - 1.) / e, -6. * m / e);
+            const double candidates[] = {
+                (anomaly - anomaly0_[j]) / root_alpha_[j],
+                bound ? parabolic_chi :
+                    (cubic_anomaly - anomaly0_[j]) / root_alpha_[j],
+                sqrt_u[i] * dt[i] / r_norm[i],
+            };
+            double best_chi = parabolic_chi;
+            double best_residual = TimeResidual(sqrt_u[i], r_norm[i],
+                sigma[i], alpha[i], dt[i], parabolic_chi);
+            for (const double candidate : candidates) {
+                const double residual = TimeResidual(sqrt_u[i], r_norm[i],
+                    sigma[i], alpha[i], dt[i], candidate);
+                best_chi = residual < best_residual ? candidate : best_chi;
+                best_residual = std::fmin(residual, best_residual);
+            }
+            chi[i] = best_chi;
+        }
+        // Fixed number of Laguerre corrections; every lane performs
+        // the same work regardless of how quickly it converges.
+        for (int iter = 0; iter < kBatchUniversalIterations; ++iter) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const double x = chi[i];
+                const double z = alpha[i] * x * x;
+                double c2, c3;
+                BatchStumpff(z, &c2, &c3);
+                const double k = 1. - alpha[i] * r_norm[i];
+                const double f = sigma[i] * x * x * c2 + k * x * x * x * c3 +
+                    r_norm[i] * x - sqrt_u[i] * dt[i];
+                const double df = sigma[i] * x * (1. - z * c3) +
+                    k * x * x * c2 + r_norm[i];
+                const double ddf = sigma[i] * (1. - z * c2) +
+                    k * x * (1. - z * c3);
+                const double order = kLaguerreOrder;
+                const double root = std::sqrt(std::fabs(
+                    (order - 1.) * (order - 1.) * df * df -
+                    order * (order - 1.) * f * ddf));
+                chi[i] = x - order * f / (df + std::copysign(root, df));
+            }
+        }
+        // Evaluate the Lagrange coefficients and apply them to the
+        // state at epoch.
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t j = start + i;
+            const double x = chi[i];
+            const double x2 = x * x;
+            const double z = alpha[i] * x2;
+            double c2, c3;
+            BatchStumpff(z, &c2, &c3);
+            const double f = 1. - x2 / r_norm[i] * c2;
+            const double g = dt[i] - x2 * x * c3 / sqrt_u[i];
+            const Vector position(
+                f * rx_[j] + g * vx_[j],
+                f * ry_[j] + g * vy_[j],
+                f * rz_[j] + g * vz_[j]);
+            const double distance = position.norm();
+            const double df =
+                sqrt_u[i] / (distance * r_norm[i]) * x * (z * c3 - 1.);
+            const double dg = 1. - x2 / distance * c2;
+            (*r)[j] = position;
+            (*v)[j] = Vector(
+                df * rx_[j] + dg * vx_[j],
+                df * ry_[j] + dg * vy_[j],
+                df * rz_[j] + dg * vz_[j]);
+        }
+    }
+}
+
+std::vector<std::vector<double>*> OrbitBatch::arrays() {
+    return {&t0_, &sqrt_u_, &r_norm_, &sigma_, &alpha_, &root_alpha_,
+            &e_, &anomaly0_, &m0_, &n_, &period_, &inv_period_,
+            &rx_, &ry_, &rz_, &vx_, &vy_, &vz_};
+}
+
+
+}  // namespace kin
@@ -0,0 +1,96 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_BATCH_H_
+#define ACTOR_SRC_BATCH_H_
+
+#include <cstddef>
+#include <vector>
+#include "orbit.h"
+#include "vector.h"
+
+namespace kin {
+
+
+/**
+ * Structure-of-arrays collection of orbits which are propagated
+ * together.
+ *
+ * Each orbit added to the batch is reduced to its state vector and
+ * the constants of the universal form of Kepler's equation (alpha,
+ * r.v and |r| at epoch, and the values used to start the solve), so
+ * orbits of every conic type (elliptic, parabolic and hyperbolic) may
+ * be mixed in one batch. Predicting the state of every orbit at one
+ * instant is a single pass over contiguous arrays, using a
+ * fixed-iteration universal-variable solver with no data-dependent
+ * branches.
+ */
+class OrbitBatch {
+ public:
+    OrbitBatch() {}
+    explicit OrbitBatch(std::size_t capacity) { Reserve(capacity); }
+
+    /**
+     * Adds orbit to batch, returning the index at which its
+     * predictions will be written.
+     *
+     * t0 is the time (in the same reference as times later passed to
+     * Predict()) at which the orbit is at its current true anomaly.
+     */
+    std::size_t Add(const Orbit &orbit, double t0 = 0.0);
+
+    void Reserve(std::size_t capacity);
+    void Clear();
+
+    /**
+     * Predicts position and velocity of every orbit in the batch at
+     * time t. Passed vectors are resized to size() and the result for
+     * the orbit at index i is written to index i.
+     *
+     * Returned vectors are relative to each orbit's reference body.
+     */
+    void Predict(
+        double t, std::vector<Vector> *r, std::vector<Vector> *v) const;
+
+    // getters
+    std::size_t size() const { return t0_.size(); }
+    bool empty() const { return t0_.empty(); }
+
+ private:
+    // Per-orbit constants, each array indexed by orbit.
+    std::vector<double> t0_;      // epoch
+    std::vector<double> sqrt_u_;  // square root of gravitational parameter
+    std::vector<double> r_norm_;  // |r| at epoch
+    std::vector<double> sigma_;   // r.v / sqrt(u) at epoch
+    std::vector<double> alpha_;   // 2 / |r| - |v|^2 / u; 1 / a
+    std::vector<double> root_alpha_;   // sqrt(|alpha|)
+    std::vector<double> e_;            // eccentricity
+    std::vector<double> anomaly0_;     // eccentric / hyperbolic anomaly
+    std::vector<double> m0_;           // mean anomaly at epoch
+    std::vector<double> n_;            // mean motion
+    std::vector<double> period_;       // period if bound; otherwise 0
+    std::vector<double> inv_period_;   // 1 / period if bound; otherwise 0
+    // State vectors at epoch
+    std::vector<double> rx_, ry_, rz_;
+    std::vector<double> vx_, vy_, vz_;
+
+    std::vector<std::vector<double>*> arrays();
+};
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_BATCH_H_
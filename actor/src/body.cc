@@ -1,14 +1,21 @@
 #include "body.h"
 
+#include <atomic>
 #include <stdexcept>
 #include <cmath>
+#include <utility>
+#include "cache.h"
 #include "uuid.h"
 
 namespace kin {
 
+
+static std::atomic<std::uint64_t> next_serial(1);  // 0 is never used.
+
 Body::Body(const double GM, const double r, const std::string id,
         Body * const parent, Orbit * const orbit):
-            GM_(GM), r_(r), id_(id.empty() ? GetUUID4() : id) {
+            GM_(GM), r_(r), id_(id.empty() ? GetUUID4() : id),
+            serial_(next_serial++), index_(kNoBodyIndex) {
     if (parent == nullptr) {
         parent_ = nullptr;
     } else {
@@ -18,6 +25,11 @@ Body::Body(const double GM, const double r, const std::string id,
         }
         parent_ = parent;
         orbit_ = std::make_unique<Orbit>(*orbit);
+        // Parabolic orbits cannot be compiled; those are predicted
+        // from orbit_ directly.
+        if (orbit_->eccentricity() != 1.0) {
+            ephemeris_ = std::make_unique<OrbitEphemeris>(*orbit_);
+        }
     }
 }
 
@@ -36,7 +48,7 @@ bool Body::AddChild(std::unique_ptr<Body> child) {
 }
 
 bool Body::IsParent(const Body &body) {
-    return children_.find(body.id()) != children_.end();
+    return body.parent_ == this;
 }
 
 double Body::sphere_of_influence() const {
@@ -44,34 +56,80 @@ double Body::sphere_of_influence() const {
     if (!HasParent()) {
         return -1.0;
     }
-    return std::pow(orbit_->semi_major_axis() * gm() / parent_->gm(), 0.4);
+    return orbit_->semi_major_axis() * std::pow(gm() / parent_->gm(), 0.4);
+}
+
+void Body::SetSystemEphemeris(std::unique_ptr<ChebyshevEphemeris> ephemeris) {
+    if (ephemeris && ephemeris->body_id() != id_) {
+        throw std::invalid_argument("Body::SetSystemEphemeris() : "
+            "Ephemeris for body " + ephemeris->body_id() +
+            " passed to body " + id_);
+    }
+    system_ephemeris_ = std::move(ephemeris);
 }
 
 Orbit Body::Predict(const double t) const { return orbit_->Predict(t); }
 
 KinematicData Body::PredictLocalKinematicData(const double t) const {
-    return HasParent() ? Predict(t).kinematic_data() : KinematicData();
+    if (!HasParent()) {
+        return KinematicData();
+    }
+    // Local data depends only on the (immutable) orbit, so it may be
+    // reused for as long as the body exists.
+    BodyStateCache &cache = BodyStateCache::Local();
+    KinematicData data;
+    if (!cache.Find(serial_, t, &data)) {
+        data = EvaluateLocalKinematicData(t);
+        cache.Insert(serial_, t, data);
+    }
+    return data;
+}
+
+KinematicData Body::EvaluateLocalKinematicData(const double t) const {
+    if (!HasParent()) {
+        return KinematicData();
+    }
+    if (ephemeris_) {
+        return ephemeris_->Predict(t);
+    }
+    const OrbitState state = orbit_->PredictState(t);
+    return {state.r, state.v};
 }
 
 KinematicData Body::PredictSystemKinematicData(const double t) const {
-    return PredictLocalKinematicData(t) + (
-        HasParent() ? parent_->PredictSystemKinematicData(t) : KinematicData());
+    // Sum local kinematic data of this body and each of its ancestors,
+    // stopping at the first with a table covering time t.
+    KinematicData data;
+    for (const Body *body = this; body->HasParent(); body = body->parent_) {
+        const ChebyshevEphemeris *table = body->system_ephemeris_.get();
+        if (table != nullptr && table->Covers(t)) {
+            return data + table->Predict(t);
+        }
+        data = data + body->PredictLocalKinematicData(t);
+    }
+    return data;
 }
 
 Vector Body::PredictLocalPosition(const double t) const {
-    return HasParent() ? Predict(t).position() : Vector(0, 0, 0);
+    return PredictLocalKinematicData(t).r;
 }
 
 Vector Body::PredictSystemPosition(const double t) const {
+    if (system_ephemeris_ && system_ephemeris_->Covers(t)) {
+        return system_ephemeris_->PredictPosition(t);
+    }
     return PredictLocalPosition(t) + (
         HasParent() ? parent_->PredictSystemPosition(t) : Vector(0, 0, 0));
 }
 
 Vector Body::PredictLocalVelocity(const double t) const {
-    return HasParent() ? Predict(t).velocity() : Vector(0, 0, 0);
+    return PredictLocalKinematicData(t).v;
 }
 
 Vector Body::PredictSystemVelocity(const double t) const {
+    if (system_ephemeris_ && system_ephemeris_->Covers(t)) {
+        return system_ephemeris_->Predict(t).v;
+    }
     return PredictLocalVelocity(t) + (
         HasParent() ? parent_->PredictSystemVelocity(t) : Vector(0, 0, 0));
 }
@@ -18,10 +18,13 @@
 #ifndef ACTOR_SRC_BODY_H_
 #define ACTOR_SRC_BODY_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include "chebyshev.h"
 #include "const.h"
+#include "ephemeris.h"
 #include "orbit.h"
 #include "vector.h"
 #include "util.h"
@@ -32,6 +35,10 @@ namespace kin {
 class Orbit;
 class Body;
 
+// Index of a body within the BodyHierarchy of its System.
+using BodyIndex = std::uint32_t;
+constexpr BodyIndex kNoBodyIndex = static_cast<BodyIndex>(-1);
+
 // alias map of bodies with their id's
 using BodyMap = std::unordered_map<std::string, std::unique_ptr<Body> >;
 using BodyIdPair = std::pair<const std::string, std::unique_ptr<Body> >;
@@ -40,9 +47,16 @@ using BodyIdPair = std::pair<const std::string, std::unique_ptr<Body> >;
 class Body {
  protected:
     const std::string id_;
+    const std::uint64_t serial_;  // Unique among bodies in this process.
     std::unique_ptr<Orbit> orbit_;
+    // Compiled form of orbit_; null if orbit_ is parabolic.
+    std::unique_ptr<OrbitEphemeris> ephemeris_;
+    // Optional table of system-frame position; used when it covers
+    // the requested time.
+    std::unique_ptr<ChebyshevEphemeris> system_ephemeris_;
     Body *parent_;
     BodyMap children_;
+    BodyIndex index_;  // Set when indexed by a BodyHierarchy.
     const double GM_;
     const double r_;
 
@@ -63,23 +77,42 @@ class Body {
     bool IsParent(const Body &body);  // Checks if direct parent of passed body.
     Orbit Predict(const double t) const;
     KinematicData PredictLocalKinematicData(const double t) const;
+    /** As PredictLocalKinematicData(), but bypasses the state cache. */
+    KinematicData EvaluateLocalKinematicData(const double t) const;
     KinematicData PredictSystemKinematicData(const double t) const;
     Vector PredictLocalPosition(const double t) const;
     Vector PredictSystemPosition(const double t) const;
     Vector PredictLocalVelocity(const double t) const;
     Vector PredictSystemVelocity(const double t) const;
 
+    /**
+     * Sets table used to predict this body's system-frame position
+     * and velocity within the table's span. Passing null removes any
+     * existing table.
+     */
+    void SetSystemEphemeris(std::unique_ptr<ChebyshevEphemeris> ephemeris);
+
     // getters
 
     const std::string& id() const { return id_; }
+    std::uint64_t serial() const { return serial_; }
+    /** Index in hierarchy of owning system; kNoBodyIndex if none. */
+    BodyIndex index() const { return index_; }
     const Body* parent() const { return parent_; }
     const Orbit* orbit() const { return orbit_.get(); }
+    /** Compiled orbit; null if body has no parent or orbit is parabolic. */
+    const OrbitEphemeris* ephemeris() const { return ephemeris_.get(); }
+    const ChebyshevEphemeris* system_ephemeris() const {
+        return system_ephemeris_.get();
+    }
     double mass() const { return GM_ / G; }
     double gm() const { return GM_; }
     double radius() const { return r_; }
     /** Calculates radius of sphere of influence. Returns -1 if no parent */
     double sphere_of_influence() const;
     const BodyMap& children() const { return children_; }
+
+    friend class BodyHierarchy;
 };
 
 
@@ -0,0 +1,72 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "cache.h"
+
+#include <cstring>
+
+namespace kin {
+
+
+constexpr std::size_t BodyStateCache::kCapacity;
+
+BodyStateCache& BodyStateCache::Local() {
+    thread_local BodyStateCache cache;
+    return cache;
+}
+
+bool BodyStateCache::Find(
+        const std::uint64_t serial, const double t, KinematicData *data) {
+    if (!enabled_) {
+        return false;
+    }
+    const Entry &entry = entries_[Slot(serial, t)];
+    if (entry.serial == serial && entry.t == t) {
+        *data = entry.data;
+        ++hits_;
+        return true;
+    }
+    ++misses_;
+    return false;
+}
+
+void BodyStateCache::Insert(const std::uint64_t serial, const double t,
+        const KinematicData &data) {
+    if (enabled_) {
+        entries_[Slot(serial, t)] = {serial, t, data};
+    }
+}
+
+void BodyStateCache::Clear() {
+    for (Entry &entry : entries_) {
+        entry.serial = 0;
+    }
+}
+
+std::size_t BodyStateCache::Slot(const std::uint64_t serial, const double t) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    // Mix key so that consecutive serials and nearby times spread
+    // across slots.
+    std::uint64_t h = (serial * 0x9E3779B97F4A7C15ull) ^ bits;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 32;
+    return static_cast<std::size_t>(h) & (kCapacity - 1);
+}
+
+
+}  // namespace kin
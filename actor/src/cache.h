@@ -0,0 +1,87 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_CACHE_H_
+#define ACTOR_SRC_CACHE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "util.h"
+
+namespace kin {
+
+
+/**
+ * Bounded cache of body kinematic data keyed by body and time.
+ *
+ * Within a single calculation step the same body is typically
+ * evaluated at the same time many times (as a peer, as the primary,
+ * and again while searching for the primary influence), so Body
+ * consults the cache of the calling thread before solving its orbit.
+ *
+ * The cache is direct-mapped: each (body, time) key hashes to a single
+ * slot, and inserting a key replaces whatever occupied its slot. Keys
+ * use a body's serial number rather than its address, so a body
+ * allocated where a destroyed one used to be never sees stale data.
+ */
+class BodyStateCache {
+ public:
+    static constexpr std::size_t kCapacity = 256;  // must be power of 2
+
+    BodyStateCache() { Clear(); }
+
+    /** Gets cache of the calling thread. */
+    static BodyStateCache& Local();
+
+    /**
+     * Looks up data stored for passed body serial and time, writing
+     * it to data and returning true if found.
+     */
+    bool Find(std::uint64_t serial, double t, KinematicData *data);
+    void Insert(std::uint64_t serial, double t, const KinematicData &data);
+
+    /** Removes all entries. Counters are unaffected. */
+    void Clear();
+    void ResetCounters() { hits_ = misses_ = 0; }
+
+    /** Enables or disables lookups and insertions. */
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+
+    // getters
+    bool enabled() const { return enabled_; }
+    std::size_t hits() const { return hits_; }
+    std::size_t misses() const { return misses_; }
+
+ private:
+    struct Entry {
+        std::uint64_t serial;  // 0 when slot is empty
+        double t;
+        KinematicData data;
+    };
+
+    std::array<Entry, kCapacity> entries_;
+    bool enabled_ = true;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+
+    static std::size_t Slot(std::uint64_t serial, double t);
+};
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_CACHE_H_
@@ -0,0 +1,379 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "chebyshev.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "body.h"
+#include "const.h"
+#include "orbit.h"
+
+namespace kin {
+
+
+constexpr int ChebyshevEphemeris::kDefaultDegree;
+constexpr int ChebyshevEphemeris::kMaxFitDepth;
+constexpr int ChebyshevEphemeris::kMaxDegree;
+
+// Initial windows span at most this fraction of the shortest orbital
+// period among the body and its ancestors.
+static constexpr double kMaxWindowPeriodFraction = 0.25;
+// Number of points per window, between fit nodes, at which the fit
+// is checked against the body's orbits.
+static constexpr int kCheckPointsPerCoefficient = 2;
+// Longest body id accepted when reading tables.
+static constexpr std::uint32_t kMaxIdLength = 4096;
+// Limit on elements reserved ahead of reading; larger arrays grow as
+// they are read, so a corrupt count fails on the missing data rather
+// than on allocation.
+static constexpr std::size_t kMaxReadReserve = 1 << 16;
+static constexpr char kFileMagic[8] = {'K', 'I', 'N', 'C', 'H', 'E', 'B', '2'};
+
+
+/** Finds exact system-frame position of body from its orbits. */
+static Vector FindSystemPosition(const Body &body, const double t) {
+    Vector r = Vector::Zero();
+    for (const Body *b = &body; b->HasParent(); b = b->parent()) {
+        r += b->PredictLocalPosition(t);
+    }
+    return r;
+}
+
+/** Finds exact system-frame state of body from its orbits. */
+static KinematicData FindSystemKinematicData(const Body &body, const double t) {
+    KinematicData data;
+    for (const Body *b = &body; b->HasParent(); b = b->parent()) {
+        data = data + b->PredictLocalKinematicData(t);
+    }
+    return data;
+}
+
+/**
+ * Evaluates series of passed degree at x in [-1, 1], writing the
+ * value of the series and its derivative with respect to x.
+ */
+static void EvaluateSeries(const double *c, const int degree, const double x,
+        double *value, double *derivative) {
+    double t_prev = 1.0, t_curr = x;      // T[j-1], T[j]
+    double dt_prev = 0.0, dt_curr = 1.0;  // T'[j-1], T'[j]
+    double sum = c[0] + (degree > 0 ? c[1] * x : 0.0);
+    double d_sum = degree > 0 ? c[1] : 0.0;
+    for (int j = 2; j <= degree; ++j) {
+        const double t_next = 2.0 * x * t_curr - t_prev;
+        const double dt_next = 2.0 * t_curr + 2.0 * x * dt_curr - dt_prev;
+        sum += c[j] * t_next;
+        d_sum += c[j] * dt_next;
+        t_prev = t_curr;
+        t_curr = t_next;
+        dt_prev = dt_curr;
+        dt_curr = dt_next;
+    }
+    *value = sum;
+    if (derivative != nullptr) {
+        *derivative = d_sum;
+    }
+}
+
+
+ChebyshevEphemeris::ChebyshevEphemeris(
+        const Body &body, const double t0, const double t1,
+        const double tolerance, const double velocity_tolerance,
+        const int degree):
+        body_id_(body.id()), degree_(degree), error_bound_(0.0),
+        velocity_error_bound_(0.0) {
+    if (!(t1 > t0)) {
+        throw std::invalid_argument("ChebyshevEphemeris() : "
+            "t1 (" + std::to_string(t1) + ") must follow t0 (" +
+            std::to_string(t0) + ")");
+    }
+    if (degree < 1 || degree > kMaxDegree ||
+            !(tolerance > 0.0) || !(velocity_tolerance > 0.0)) {
+        throw std::invalid_argument("ChebyshevEphemeris() : "
+            "degree must be within 1 to " + std::to_string(kMaxDegree) +
+            " and tolerances > 0.");
+    }
+    // Initial window length is limited by the fastest orbit affecting
+    // the body's system-frame position.
+    double max_window = t1 - t0;
+    for (const Body *b = &body; b->HasParent(); b = b->parent()) {
+        if (b->orbit()->eccentricity() < 1.0) {
+            max_window = std::min(
+                max_window, b->orbit()->period() * kMaxWindowPeriodFraction);
+        }
+    }
+    const int n_initial = static_cast<int>(std::ceil((t1 - t0) / max_window));
+    const double window = (t1 - t0) / n_initial;
+    bounds_.push_back(t0);
+    for (int i = 0; i < n_initial; ++i) {
+        const double b = i == n_initial - 1 ? t1 : t0 + window * (i + 1);
+        FitWindow(body, bounds_.back(), b, tolerance, velocity_tolerance, 0);
+    }
+}
+
+/**
+ * Fits window [a, b] and appends it to the table, subdividing it if
+ * the fit does not meet passed tolerances.
+ */
+void ChebyshevEphemeris::FitWindow(const Body &body, const double a,
+        const double b, const double tolerance,
+        const double velocity_tolerance, const int depth) {
+    const int n = degree_ + 1;
+    const double mid = (a + b) / 2;
+    const double half = (b - a) / 2;
+    // Sample positions at Chebyshev nodes.
+    std::vector<Vector> samples(n);
+    for (int k = 0; k < n; ++k) {
+        samples[k] = FindSystemPosition(
+            body, mid + half * std::cos(PI * (k + 0.5) / n));
+    }
+    std::vector<double> c(3 * n, 0.0);
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int j = 0; j < n; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < n; ++k) {
+                sum += samples[k](axis) * std::cos(PI * j * (k + 0.5) / n);
+            }
+            c[axis * n + j] = sum * (j == 0 ? 1.0 : 2.0) / n;
+        }
+    }
+    // Check fit at points between nodes.
+    const int n_checks = kCheckPointsPerCoefficient * n;
+    double error = 0.0;
+    double velocity_error = 0.0;
+    for (int i = 0; i <= n_checks; ++i) {
+        const double x = -1.0 + 2.0 * i / n_checks;
+        KinematicData fit;
+        for (int axis = 0; axis < 3; ++axis) {
+            double derivative;
+            EvaluateSeries(&c[axis * n], degree_, x, &fit.r(axis), &derivative);
+            fit.v(axis) = derivative / half;
+        }
+        const KinematicData expected =
+            FindSystemKinematicData(body, mid + half * x);
+        error = std::max(error, (fit.r - expected.r).norm());
+        velocity_error = std::max(velocity_error, (fit.v - expected.v).norm());
+    }
+    if (error > tolerance || velocity_error > velocity_tolerance) {
+        if (depth == kMaxFitDepth) {
+            throw std::runtime_error("ChebyshevEphemeris() : "
+                "Could not fit " + body_id_ + " within tolerance between " +
+                std::to_string(a) + " and " + std::to_string(b) +
+                "; position error: " + std::to_string(error) +
+                ", velocity error: " + std::to_string(velocity_error));
+        }
+        FitWindow(body, a, mid, tolerance, velocity_tolerance, depth + 1);
+        FitWindow(body, mid, b, tolerance, velocity_tolerance, depth + 1);
+        return;
+    }
+    error_bound_ = std::max(error_bound_, error);
+    velocity_error_bound_ = std::max(velocity_error_bound_, velocity_error);
+    bounds_.push_back(b);
+    coefficients_.insert(coefficients_.end(), c.begin(), c.end());
+}
+
+std::size_t ChebyshevEphemeris::FindWindow(const double t) const {
+    if (!Covers(t)) {
+        throw std::out_of_range("ChebyshevEphemeris::FindWindow() : "
+            "t: " + std::to_string(t) + " outside of table span " +
+            std::to_string(t0()) + " to " + std::to_string(t1()));
+    }
+    // Index of last boundary <= t, clamped so that t1 falls in the
+    // final window.
+    const std::size_t i = std::upper_bound(
+        bounds_.begin(), bounds_.end(), t) - bounds_.begin();
+    return std::min(i, bounds_.size() - 1) - 1;
+}
+
+KinematicData ChebyshevEphemeris::Predict(const double t) const {
+    const std::size_t window = FindWindow(t);
+    const int n = degree_ + 1;
+    const double a = bounds_[window];
+    const double half = (bounds_[window + 1] - a) / 2;
+    const double x = (t - a) / half - 1.0;
+    const double *c = &coefficients_[window * 3 * n];
+    KinematicData data;
+    for (int axis = 0; axis < 3; ++axis) {
+        double derivative;
+        EvaluateSeries(c + axis * n, degree_, x, &data.r(axis), &derivative);
+        data.v(axis) = derivative / half;
+    }
+    return data;
+}
+
+Vector ChebyshevEphemeris::PredictPosition(const double t) const {
+    const std::size_t window = FindWindow(t);
+    const int n = degree_ + 1;
+    const double a = bounds_[window];
+    const double half = (bounds_[window + 1] - a) / 2;
+    const double x = (t - a) / half - 1.0;
+    const double *c = &coefficients_[window * 3 * n];
+    Vector r;
+    for (int axis = 0; axis < 3; ++axis) {
+        EvaluateSeries(c + axis * n, degree_, x, &r(axis), nullptr);
+    }
+    return r;
+}
+
+// Serialization ------------------------------------------------------
+
+static void WriteUInt32(std::ostream *out, const std::uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    out->write(bytes, 4);
+}
+
+static void WriteDouble(std::ostream *out, const double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+    }
+    out->write(bytes, 8);
+}
+
+static void ReadBytes(std::istream *in, char *bytes, const std::size_t n) {
+    if (!in->read(bytes, n)) {
+        throw std::runtime_error("ChebyshevEphemeris : "
+            "Unexpected end of ephemeris data.");
+    }
+}
+
+static std::uint32_t ReadUInt32(std::istream *in) {
+    unsigned char bytes[4];
+    ReadBytes(in, reinterpret_cast<char*>(bytes), 4);
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<std::uint32_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+static double ReadDouble(std::istream *in) {
+    unsigned char bytes[8];
+    ReadBytes(in, reinterpret_cast<char*>(bytes), 8);
+    std::uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+        bits |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void ChebyshevEphemeris::Write(std::ostream *out) const {
+    WriteUInt32(out, static_cast<std::uint32_t>(body_id_.size()));
+    out->write(body_id_.data(), body_id_.size());
+    WriteUInt32(out, static_cast<std::uint32_t>(degree_));
+    WriteUInt32(out, static_cast<std::uint32_t>(n_windows()));
+    WriteDouble(out, error_bound_);
+    WriteDouble(out, velocity_error_bound_);
+    for (const double bound : bounds_) {
+        WriteDouble(out, bound);
+    }
+    for (const double coefficient : coefficients_) {
+        WriteDouble(out, coefficient);
+    }
+}
+
+ChebyshevEphemeris ChebyshevEphemeris::Read(std::istream *in) {
+    ChebyshevEphemeris table;
+    const std::uint32_t id_length = ReadUInt32(in);
+    if (id_length > kMaxIdLength) {
+        throw std::runtime_error("ChebyshevEphemeris::Read() : "
+            "Body id length " + std::to_string(id_length) + " exceeds " +
+            std::to_string(kMaxIdLength));
+    }
+    table.body_id_.resize(id_length);
+    if (!table.body_id_.empty()) {
+        ReadBytes(in, &table.body_id_[0], table.body_id_.size());
+    }
+    const std::uint32_t degree = ReadUInt32(in);
+    const std::uint32_t n_windows = ReadUInt32(in);
+    if (degree < 1 || degree > static_cast<std::uint32_t>(kMaxDegree) ||
+            n_windows < 1) {
+        throw std::runtime_error("ChebyshevEphemeris::Read() : "
+            "Invalid table header; degree: " + std::to_string(degree) +
+            ", windows: " + std::to_string(n_windows));
+    }
+    table.degree_ = static_cast<int>(degree);
+    // Sizes are found in size_t, which may be 32 bits wide.
+    const std::size_t per_window = 3 * (static_cast<std::size_t>(degree) + 1);
+    if (n_windows > std::numeric_limits<std::size_t>::max() / per_window) {
+        throw std::runtime_error("ChebyshevEphemeris::Read() : "
+            "Table of " + std::to_string(n_windows) + " windows is too large.");
+    }
+    const std::size_t n_bounds = static_cast<std::size_t>(n_windows) + 1;
+    const std::size_t n_coefficients = n_windows * per_window;
+
+    table.error_bound_ = ReadDouble(in);
+    table.velocity_error_bound_ = ReadDouble(in);
+    table.bounds_.reserve(std::min(n_bounds, kMaxReadReserve));
+    for (std::size_t i = 0; i < n_bounds; ++i) {
+        const double bound = ReadDouble(in);
+        if (!std::isfinite(bound) ||
+                (!table.bounds_.empty() && !(bound > table.bounds_.back()))) {
+            throw std::runtime_error("ChebyshevEphemeris::Read() : "
+                "Window boundaries must be finite and strictly increasing.");
+        }
+        table.bounds_.push_back(bound);
+    }
+    table.coefficients_.reserve(std::min(n_coefficients, kMaxReadReserve));
+    for (std::size_t i = 0; i < n_coefficients; ++i) {
+        table.coefficients_.push_back(ReadDouble(in));
+    }
+    if (!in->good()) {
+        throw std::runtime_error("ChebyshevEphemeris::Read() : "
+            "Failed to read ephemeris data.");
+    }
+    return table;
+}
+
+void WriteEphemerides(
+        std::ostream *out, const std::vector<ChebyshevEphemeris> &tables) {
+    out->write(kFileMagic, sizeof(kFileMagic));
+    WriteUInt32(out, static_cast<std::uint32_t>(tables.size()));
+    for (const ChebyshevEphemeris &table : tables) {
+        table.Write(out);
+    }
+}
+
+std::vector<ChebyshevEphemeris> ReadEphemerides(std::istream *in) {
+    char magic[sizeof(kFileMagic)];
+    ReadBytes(in, magic, sizeof(magic));
+    if (std::memcmp(magic, kFileMagic, sizeof(magic)) != 0) {
+        throw std::runtime_error("ReadEphemerides() : "
+            "Data is not a kinetic ephemeris file.");
+    }
+    const std::uint32_t n_tables = ReadUInt32(in);
+    std::vector<ChebyshevEphemeris> tables;
+    tables.reserve(std::min<std::size_t>(n_tables, kMaxReadReserve));
+    for (std::uint32_t i = 0; i < n_tables; ++i) {
+        tables.push_back(ChebyshevEphemeris::Read(in));
+    }
+    return tables;
+}
+
+
+}  // namespace kin
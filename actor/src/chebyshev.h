@@ -0,0 +1,137 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_CHEBYSHEV_H_
+#define ACTOR_SRC_CHEBYSHEV_H_
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "vector.h"
+#include "util.h"
+
+namespace kin {
+
+// forward declarations
+class Body;
+
+
+/**
+ * Piecewise Chebyshev approximation of the system-frame trajectory of
+ * a Body over a fixed span of time, in the manner of the JPL
+ * planetary ephemerides.
+ *
+ * The span is divided into windows, each holding a Chebyshev series
+ * for each of x, y and z. Velocity is the derivative of the position
+ * series. Windows are subdivided while fitting until the position and
+ * velocity errors, measured against the body's orbits at points
+ * between the fit nodes, are within the requested tolerances; the
+ * largest errors measured are kept as error_bound() and
+ * velocity_error_bound().
+ *
+ * Evaluating the table is a short polynomial evaluation, regardless
+ * of how deep in the system the body is.
+ */
+class ChebyshevEphemeris {
+ public:
+    static constexpr int kDefaultDegree = 13;
+    // Limit on window subdivision; 2^-20 of the initial window length.
+    static constexpr int kMaxFitDepth = 20;
+    static constexpr int kMaxDegree = 64;
+
+    /**
+     * Fits table to system-frame position of passed body between
+     * times t0 and t1, with passed position tolerance in meters and
+     * velocity tolerance in meters per second.
+     *
+     * Throws std::runtime_error if a window cannot meet the
+     * tolerances after kMaxFitDepth subdivisions.
+     */
+    ChebyshevEphemeris(const Body &body, double t0, double t1,
+        double tolerance, double velocity_tolerance,
+        int degree = kDefaultDegree);
+
+    KinematicData Predict(const double t) const;
+    Vector PredictPosition(const double t) const;
+
+    /** Checks whether passed time lies within the table's span. */
+    bool Covers(const double t) const { return t >= t0() && t <= t1(); }
+
+    /** Writes table in the binary format described in Read(). */
+    void Write(std::ostream *out) const;
+
+    /**
+     * Reads a single table. All values are little-endian; doubles are
+     * IEEE-754 binary64.
+     *
+     *   uint32  length of body id, followed by id bytes
+     *   uint32  degree
+     *   uint32  number of windows n
+     *   double  error bound (m)
+     *   double  velocity error bound (m/s)
+     *   double  window boundaries [n + 1]
+     *   double  coefficients [n][3][degree + 1]  (x, y, z series)
+     *
+     * Throws std::runtime_error if the data is truncated, the degree
+     * is outside 1 to kMaxDegree, or window boundaries are not
+     * finite and strictly increasing.
+     */
+    static ChebyshevEphemeris Read(std::istream *in);
+
+    // getters
+    const std::string& body_id() const { return body_id_; }
+    double t0() const { return bounds_.front(); }
+    double t1() const { return bounds_.back(); }
+    int degree() const { return degree_; }
+    std::size_t n_windows() const { return bounds_.size() - 1; }
+    /** Largest position error (m) found when the table was fit. */
+    double error_bound() const { return error_bound_; }
+    /** Largest velocity error (m/s) found when the table was fit. */
+    double velocity_error_bound() const { return velocity_error_bound_; }
+
+ private:
+    std::string body_id_;
+    int degree_;
+    double error_bound_;
+    double velocity_error_bound_;
+    std::vector<double> bounds_;        // window boundaries
+    std::vector<double> coefficients_;  // 3 * (degree_ + 1) per window
+
+    ChebyshevEphemeris():
+        degree_(0), error_bound_(0.0), velocity_error_bound_(0.0) {}
+
+    void FitWindow(const Body &body, double a, double b,
+        double tolerance, double velocity_tolerance, int depth);
+    std::size_t FindWindow(const double t) const;
+};
+
+
+/**
+ * Writes passed tables to a stream, preceded by a header of the
+ * 8 bytes "KINCHEB2" and a uint32 count of tables.
+ */
+void WriteEphemerides(
+    std::ostream *out, const std::vector<ChebyshevEphemeris> &tables);
+
+/** Reads tables written by WriteEphemerides(). */
+std::vector<ChebyshevEphemeris> ReadEphemerides(std::istream *in);
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_CHEBYSHEV_H_
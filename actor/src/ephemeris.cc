@@ -0,0 +1,155 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "ephemeris.h"
+
+#include <cmath>
+#include <stdexcept>
+#include "kepler.h"
+#include "orbit.h"
+
+namespace kin {
+
+
+OrbitEphemeris::OrbitEphemeris(const Orbit &orbit):
+        e_(orbit.eccentricity()),
+        a_(orbit.semi_major_axis()),
+        transform_(orbit.perifocal_transform()) {
+    if (e_ == 1.0) {
+        throw std::invalid_argument("OrbitEphemeris::OrbitEphemeris() : "
+            "Parabolic orbits (e == 1) are not supported.");
+    }
+    const double u = orbit.gravitational_parameter();
+    const double abs_a = std::fabs(a_);
+    s_ = std::sqrt(std::fabs(1.0 - e_ * e_));
+    b_ = abs_a * s_;
+    n_ = std::sqrt(u / (abs_a * abs_a * abs_a));
+    k_ = std::sqrt(u * abs_a);
+    m0_ = e_ == 0.0 ? orbit.true_anomaly() : orbit.mean_anomaly();
+}
+
+OrbitEphemeris::OrbitEphemeris(const PackedEphemeris &packed):
+        e_(packed.e),
+        a_(packed.a),
+        n_(packed.n),
+        m0_(packed.m0),
+        transform_(Quaternion(packed.rotation[3], packed.rotation[0],
+                              packed.rotation[1], packed.rotation[2])) {
+    const double abs_a = std::fabs(a_);
+    s_ = std::sqrt(std::fabs(1.0 - e_ * e_));
+    b_ = abs_a * s_;
+    k_ = n_ * abs_a * abs_a;  // sqrt(u |a|), as n = sqrt(u / |a|^3)
+}
+
+PackedEphemeris OrbitEphemeris::Pack() const {
+    const Quaternion rotation(transform_);
+    return {e_, a_, n_, m0_,
+            {rotation.x(), rotation.y(), rotation.z(), rotation.w()}};
+}
+
+KinematicData OrbitEphemeris::Predict(
+        const double time, const KeplerTolerance tolerance) const {
+    return Evaluate(SolveKepler(e_, FindMeanAnomaly(time), tolerance));
+}
+
+Vector OrbitEphemeris::PredictPosition(
+        const double time, const KeplerTolerance tolerance) const {
+    return EvaluatePosition(
+        SolveKepler(e_, FindMeanAnomaly(time), tolerance));
+}
+
+double OrbitEphemeris::FindMeanAnomaly(const double time) const {
+    const double M = m0_ + n_ * time;
+    if (std::isnan(M)) {
+        throw std::invalid_argument("OrbitEphemeris::FindMeanAnomaly() : "
+            "Mean anomaly was NaN.");
+    }
+    return M;
+}
+
+KinematicData OrbitEphemeris::Evaluate(const double anomaly) const {
+    const double E = anomaly;
+    double p, q, vp, vq;
+    if (e_ < 1.0) {
+        const double sin_E = std::sin(E);
+        const double cos_E = std::cos(E);
+        const double distance = a_ * (1.0 - e_ * cos_E);
+        p = a_ * (cos_E - e_);
+        q = b_ * sin_E;
+        vp = -k_ / distance * sin_E;
+        vq = k_ / distance * s_ * cos_E;
+    } else {
+        const double sinh_E = std::sinh(E);
+        const double cosh_E = std::cosh(E);
+        const double distance = a_ * (1.0 - e_ * cosh_E);
+        p = a_ * (cosh_E - e_);
+        q = b_ * sinh_E;
+        vp = -k_ / distance * sinh_E;
+        vq = k_ / distance * s_ * cosh_E;
+    }
+    return {transform_ * Vector(p, q, 0.0), transform_ * Vector(vp, vq, 0.0)};
+}
+
+Vector OrbitEphemeris::EvaluatePosition(const double anomaly) const {
+    const double E = anomaly;
+    const double p = e_ < 1.0 ?
+        a_ * (std::cos(E) - e_) : a_ * (std::cosh(E) - e_);
+    const double q = e_ < 1.0 ? b_ * std::sin(E) : b_ * std::sinh(E);
+    return transform_ * Vector(p, q, 0.0);
+}
+
+// EphemerisCursor ----------------------------------------------------
+
+KinematicData EphemerisCursor::Predict(const double time) {
+    return ephemeris_.Evaluate(FindAnomaly(time));
+}
+
+Vector EphemerisCursor::PredictPosition(const double time) {
+    return ephemeris_.EvaluatePosition(FindAnomaly(time));
+}
+
+double EphemerisCursor::FindAnomaly(const double time) {
+    const double e = ephemeris_.eccentricity();
+    const double M = ephemeris_.FindMeanAnomaly(time);
+    double E;
+    if (has_solution_) {
+        // Extrapolate previous solution to second order. With
+        // f(E) = E - e sin E - M (e sinh E - E - M if e > 1),
+        // dE/dM = 1 / f'(E) and d2E/dM2 = -f''(E) / f'(E)^3.
+        const double slope = e < 1.0 ?
+            1.0 - e * std::cos(last_anomaly_) :
+            e * std::cosh(last_anomaly_) - 1.0;
+        const double curvature = e < 1.0 ?
+            e * std::sin(last_anomaly_) :
+            e * std::sinh(last_anomaly_);
+        const double dM = M - last_mean_anomaly_;
+        const double guess = last_anomaly_ + dM / slope -
+            0.5 * dM * dM * curvature / (slope * slope * slope);
+        E = SolveKeplerFrom(
+            e, M, guess, kPhysicsTolerance, &last_iterations_);
+    } else {
+        E = SolveKepler(e, M, kPhysicsTolerance, &last_iterations_);
+    }
+    last_mean_anomaly_ = M;
+    last_anomaly_ = E;
+    has_solution_ = true;
+    total_iterations_ += last_iterations_;
+    ++n_evaluations_;
+    return E;
+}
+
+
+}  // namespace kin
@@ -0,0 +1,145 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_EPHEMERIS_H_
+#define ACTOR_SRC_EPHEMERIS_H_
+
+#include <cstddef>
+#include "kepler.h"
+#include "vector.h"
+#include "util.h"
+
+namespace kin {
+
+// forward declarations
+class Orbit;
+
+
+/**
+ * Minimal form of an OrbitEphemeris, for storing large numbers of
+ * them. Values which can be derived from the others are omitted, and
+ * the perifocal rotation is stored as a quaternion.
+ *
+ * This is plain data, so that it may be held in unions.
+ */
+struct PackedEphemeris {
+    double e;            // eccentricity
+    double a;            // semi-major axis
+    double n;            // mean motion
+    double m0;           // mean anomaly at epoch
+    double rotation[4];  // perifocal frame -> reference; x, y, z, w
+};
+
+
+/**
+ * Immutable, precompiled form of an Orbit, intended for repeated
+ * evaluation.
+ *
+ * All values that do not change as the orbit is advanced (mean
+ * motion, semi-minor axis, velocity scale, and the rotation from the
+ * perifocal frame into the reference frame) are computed once on
+ * construction, so that evaluating the orbit at a time is a single
+ * Kepler solve followed by a single rotation.
+ *
+ * Times passed to evaluation methods are relative to the moment the
+ * source Orbit was at its current true anomaly, as in
+ * Orbit::Predict().
+ */
+class OrbitEphemeris {
+ public:
+    explicit OrbitEphemeris(const Orbit &orbit);
+    explicit OrbitEphemeris(const PackedEphemeris &packed);
+
+    PackedEphemeris Pack() const;
+
+    KinematicData Predict(const double time,
+        const KeplerTolerance tolerance = kPhysicsTolerance) const;
+    Vector PredictPosition(const double time,
+        const KeplerTolerance tolerance = kPhysicsTolerance) const;
+
+    /** Finds mean anomaly at passed time relative to epoch. */
+    double FindMeanAnomaly(const double time) const;
+
+    /**
+     * Evaluates orbit at a known eccentric anomaly (hyperbolic
+     * anomaly if e > 1), skipping the Kepler solve.
+     */
+    KinematicData Evaluate(const double anomaly) const;
+    Vector EvaluatePosition(const double anomaly) const;
+
+    // getters
+    double eccentricity() const { return e_; }
+    double mean_motion() const { return n_; }
+    double epoch_mean_anomaly() const { return m0_; }
+    const Matrix& transform() const { return transform_; }
+
+ private:
+    double e_;   // eccentricity
+    double a_;   // semi-major axis
+    double b_;   // perifocal q-axis scale; |a| * sqrt(|1 - e^2|)
+    double s_;   // sqrt(|1 - e^2|)
+    double n_;   // mean motion
+    double m0_;  // mean anomaly at epoch
+    double k_;   // sqrt(u * |a|); scales perifocal velocity
+    Matrix transform_;  // perifocal frame -> reference body frame
+};
+
+
+/**
+ * Evaluates an OrbitEphemeris at a sequence of times, using the
+ * solution of each evaluation as the starting point for the next.
+ *
+ * When times passed to the cursor are close together, as when a
+ * client animates or scrubs through time, each Kepler solve needs
+ * only about one Newton iteration.
+ *
+ * The cursor keeps a reference to the passed ephemeris, which must
+ * outlive it.
+ */
+class EphemerisCursor {
+ public:
+    explicit EphemerisCursor(const OrbitEphemeris &ephemeris):
+        ephemeris_(ephemeris), has_solution_(false),
+        last_iterations_(0), total_iterations_(0), n_evaluations_(0) {}
+
+    KinematicData Predict(const double time);
+    Vector PredictPosition(const double time);
+
+    /** Forgets the previous solution; the next solve starts cold. */
+    void Reset() { has_solution_ = false; }
+
+    // getters
+    const OrbitEphemeris& ephemeris() const { return ephemeris_; }
+    int last_iterations() const { return last_iterations_; }
+    std::size_t total_iterations() const { return total_iterations_; }
+    std::size_t n_evaluations() const { return n_evaluations_; }
+
+ private:
+    const OrbitEphemeris &ephemeris_;
+    bool has_solution_;
+    double last_mean_anomaly_;
+    double last_anomaly_;
+    int last_iterations_;
+    std::size_t total_iterations_;
+    std::size_t n_evaluations_;
+
+    double FindAnomaly(const double time);
+};
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_EPHEMERIS_H_
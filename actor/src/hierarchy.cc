@@ -0,0 +1,72 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "hierarchy.h"
+
+#include <atomic>
+#include <stdexcept>
+
+namespace kin {
+
+
+static std::atomic<std::uint64_t> next_generation(1);  // 0 is never used.
+
+BodyHierarchy::BodyHierarchy(Body * const root):
+        generation_(next_generation++) {
+    // Children of the body at index i are appended while i is
+    // visited, so they are contiguous and follow every body at a
+    // lower depth.
+    std::vector<Body*> bodies = {root};
+    nodes_.push_back({root, kNoBodyIndex, 0, 0, root->sphere_of_influence()});
+    for (std::size_t i = 0; i < bodies.size(); ++i) {
+        Body *body = bodies[i];
+        body->index_ = static_cast<BodyIndex>(i);
+        ids_[body->id()] = static_cast<BodyIndex>(i);
+        nodes_[i].first_child = static_cast<BodyIndex>(nodes_.size());
+        nodes_[i].n_children = static_cast<BodyIndex>(body->children().size());
+        for (const BodyIdPair &child_pair : body->children()) {
+            Body *child = child_pair.second.get();
+            bodies.push_back(child);
+            nodes_.push_back({child, static_cast<BodyIndex>(i), 0, 0,
+                child->sphere_of_influence()});
+        }
+    }
+    orbits_.Reserve(nodes_.size() - 1);
+    for (std::size_t i = 1; i < nodes_.size(); ++i) {
+        orbits_.Add(*nodes_[i].body->orbit());
+    }
+}
+
+BodyIndex BodyHierarchy::Find(const std::string &id) const {
+    const auto it = ids_.find(id);
+    if (it == ids_.end()) {
+        throw std::out_of_range("BodyHierarchy::Find() : "
+            "No body with id " + id + " in hierarchy.");
+    }
+    return it->second;
+}
+
+BodyIndex BodyHierarchy::IndexOf(const Body &body) const {
+    if (!Contains(body)) {
+        throw std::out_of_range("BodyHierarchy::IndexOf() : "
+            "Body " + body.id() + " is not in hierarchy; it may have been "
+            "added after the hierarchy was built.");
+    }
+    return body.index();
+}
+
+
+}  // namespace kin
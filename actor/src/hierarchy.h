@@ -0,0 +1,110 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_HIERARCHY_H_
+#define ACTOR_SRC_HIERARCHY_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "batch.h"
+#include "body.h"
+
+namespace kin {
+
+
+/**
+ * Flattened, index-based form of a tree of bodies.
+ *
+ * Bodies are stored in one contiguous array in breadth-first order,
+ * so each body's parent precedes it and the children of each body
+ * occupy a contiguous range of indices. Each body is given its
+ * BodyIndex within the hierarchy, so identity checks and traversals
+ * are integer operations; string ids are only used by Find().
+ *
+ * Values which never change for a body (such as its sphere of
+ * influence) are cached alongside it, and the local orbits of all
+ * bodies but the root are gathered into an OrbitBatch, so that every
+ * orbit may be evaluated in one pass.
+ *
+ * The hierarchy keeps pointers to the bodies it was created from;
+ * it must be rebuilt if bodies are added to the tree. Each hierarchy
+ * is given a generation number unique within the process, so that
+ * data produced from an earlier hierarchy can be recognized.
+ */
+class BodyHierarchy {
+ public:
+    BodyHierarchy(): generation_(0) {}
+    /** Flattens tree of bodies descending from passed root. */
+    explicit BodyHierarchy(Body *root);
+
+    /**
+     * Finds index of body with passed id. Throws std::out_of_range
+     * if no such body is in the hierarchy.
+     */
+    BodyIndex Find(const std::string &id) const;
+    bool Contains(const std::string &id) const { return ids_.count(id) > 0; }
+    /** Whether passed body is the body at its index in hierarchy. */
+    bool Contains(const Body &body) const {
+        return body.index() < nodes_.size() &&
+               nodes_[body.index()].body == &body;
+    }
+    /**
+     * Gets index of passed body. Throws std::out_of_range if the body
+     * is not in the hierarchy, as when it was added to the tree after
+     * the hierarchy was built.
+     */
+    BodyIndex IndexOf(const Body &body) const;
+
+    // getters
+    std::size_t size() const { return nodes_.size(); }
+    std::uint64_t generation() const { return generation_; }
+    const Body& body(BodyIndex i) const { return *nodes_[i].body; }
+    Body* mutable_body(BodyIndex i) const { return nodes_[i].body; }
+    BodyIndex parent(BodyIndex i) const { return nodes_[i].parent; }
+    BodyIndex first_child(BodyIndex i) const { return nodes_[i].first_child; }
+    BodyIndex n_children(BodyIndex i) const { return nodes_[i].n_children; }
+    BodyIndex children_end(BodyIndex i) const {
+        return nodes_[i].first_child + nodes_[i].n_children;
+    }
+    /** Radius of sphere of influence; -1 for the root. */
+    double sphere_of_influence(BodyIndex i) const { return nodes_[i].soi; }
+    /**
+     * Local orbits of every body but the root, in index order; the
+     * orbit of the body at index i is at batch index i - 1.
+     */
+    const OrbitBatch& orbits() const { return orbits_; }
+
+ private:
+    struct Node {
+        Body *body;
+        BodyIndex parent;
+        BodyIndex first_child;
+        BodyIndex n_children;
+        double soi;
+    };
+
+    std::uint64_t generation_;
+    std::vector<Node> nodes_;
+    OrbitBatch orbits_;
+    std::unordered_map<std::string, BodyIndex> ids_;
+};
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_HIERARCHY_H_
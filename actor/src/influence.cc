@@ -0,0 +1,139 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "influence.h"
+
+#include <algorithm>
+#include <limits>
+#include "hierarchy.h"
+
+namespace kin {
+
+
+constexpr std::uint32_t InfluenceIndex::kNoNode;
+constexpr BodyIndex InfluenceIndex::kMaxLeafSize;
+
+InfluenceIndex::InfluenceIndex(const SystemSnapshot &snapshot):
+        snapshot_(snapshot) {
+    const BodyHierarchy &hierarchy = snapshot.hierarchy();
+    roots_.resize(hierarchy.size(), kNoNode);
+    for (BodyIndex i = 0; i < hierarchy.size(); ++i) {
+        const BodyIndex n_children = hierarchy.n_children(i);
+        if (n_children == 0) {
+            continue;
+        }
+        const std::uint32_t first =
+            static_cast<std::uint32_t>(leaf_bodies_.size());
+        for (BodyIndex child = hierarchy.first_child(i);
+                child < hierarchy.children_end(i); ++child) {
+            leaf_bodies_.push_back(child);
+        }
+        roots_[i] = Build(first, n_children);
+    }
+}
+
+BodyIndex InfluenceIndex::FindPrimaryInfluence(const Vector &r) const {
+    // Descend from the root, as long as r is within the SOI of one of
+    // the current primary's children.
+    BodyIndex primary = 0;
+    while (roots_[primary] != kNoNode) {
+        const BodyIndex child = FindChild(roots_[primary], r);
+        if (child == kNoBodyIndex) {
+            break;
+        }
+        primary = child;
+    }
+    return primary;
+}
+
+std::uint32_t InfluenceIndex::Build(
+        const std::uint32_t first, const std::uint32_t count) {
+    const BodyHierarchy &hierarchy = snapshot_.hierarchy();
+    const auto begin = leaf_bodies_.begin() + first;
+    const auto end = begin + count;
+
+    // Find box around spheres, which is used both to choose the axis
+    // along which to split them, and as the center of the node.
+    const double inf = std::numeric_limits<double>::infinity();
+    Vector lower = Vector::Constant(inf);
+    Vector upper = Vector::Constant(-inf);
+    for (auto it = begin; it != end; ++it) {
+        const Vector soi =
+            Vector::Constant(hierarchy.sphere_of_influence(*it));
+        lower = lower.cwiseMin(snapshot_.position(*it) - soi);
+        upper = upper.cwiseMax(snapshot_.position(*it) + soi);
+    }
+    Node node;
+    node.center = (lower + upper) / 2.0;
+    node.radius = 0.0;
+    for (auto it = begin; it != end; ++it) {
+        node.radius = std::max(node.radius,
+            (snapshot_.position(*it) - node.center).norm() +
+            hierarchy.sphere_of_influence(*it));
+    }
+    node.left = node.right = kNoNode;
+    node.first = first;
+    node.count = count;
+    const std::uint32_t index = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.push_back(node);
+    if (count <= kMaxLeafSize) {
+        return index;
+    }
+
+    // Split at median along longest axis of box.
+    int axis;
+    (upper - lower).maxCoeff(&axis);
+    const std::uint32_t half = count / 2;
+    std::nth_element(begin, begin + half, end,
+        [this, axis](const BodyIndex a, const BodyIndex b) {
+            return snapshot_.position(a)[axis] < snapshot_.position(b)[axis];
+        });
+    const std::uint32_t left = Build(first, half);
+    const std::uint32_t right = Build(first + half, count - half);
+    nodes_[index].left = left;
+    nodes_[index].right = right;
+    return index;
+}
+
+BodyIndex InfluenceIndex::FindChild(
+        const std::uint32_t root, const Vector &r) const {
+    // Children of the same parent are assumed not to have overlapping
+    // spheres of influence, so the first containing sphere is taken.
+    std::uint32_t stack[64];
+    std::size_t stack_size = 0;
+    stack[stack_size++] = root;
+    while (stack_size > 0) {
+        const Node &node = nodes_[stack[--stack_size]];
+        if ((r - node.center).squaredNorm() >= node.radius * node.radius) {
+            continue;
+        }
+        if (node.left == kNoNode) {
+            for (std::uint32_t i = node.first;
+                    i < node.first + node.count; ++i) {
+                if (snapshot_.InSphereOfInfluence(leaf_bodies_[i], r)) {
+                    return leaf_bodies_[i];
+                }
+            }
+        } else {
+            stack[stack_size++] = node.left;
+            stack[stack_size++] = node.right;
+        }
+    }
+    return kNoBodyIndex;
+}
+
+
+}  // namespace kin
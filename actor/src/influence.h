@@ -0,0 +1,80 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_INFLUENCE_H_
+#define ACTOR_SRC_INFLUENCE_H_
+
+#include <cstdint>
+#include <vector>
+#include "body.h"
+#include "snapshot.h"
+#include "vector.h"
+
+namespace kin {
+
+
+/**
+ * Spatial index of the spheres of influence of every body in a
+ * system snapshot, used to find the primary influence at many
+ * positions at the same time.
+ *
+ * The children of each body are arranged in a bounding sphere
+ * hierarchy: a binary tree whose leaves are the children's spheres
+ * of influence and whose inner nodes are spheres enclosing their
+ * subtrees. Finding which child's SOI contains a position then
+ * visits O(log(children)) nodes rather than every child.
+ *
+ * The index keeps a reference to the snapshot it was built from,
+ * which must outlive it.
+ */
+class InfluenceIndex {
+ public:
+    explicit InfluenceIndex(const SystemSnapshot &snapshot);
+
+    /** Finds index of body which is the primary influence at r. */
+    BodyIndex FindPrimaryInfluence(const Vector &r) const;
+
+    // getters
+    const SystemSnapshot& snapshot() const { return snapshot_; }
+
+ private:
+    static constexpr std::uint32_t kNoNode = static_cast<std::uint32_t>(-1);
+    static constexpr BodyIndex kMaxLeafSize = 4;
+
+    // Node of bounding sphere hierarchy. Leaves list a range of
+    // children in leaf_bodies_; inner nodes have two child nodes.
+    struct Node {
+        Vector center;
+        double radius;
+        std::uint32_t left;   // kNoNode for leaves
+        std::uint32_t right;
+        std::uint32_t first;  // index into leaf_bodies_ (leaves only)
+        std::uint32_t count;
+    };
+
+    const SystemSnapshot &snapshot_;
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> roots_;  // root node of each body's children
+    std::vector<BodyIndex> leaf_bodies_;
+
+    std::uint32_t Build(std::uint32_t first, std::uint32_t count);
+    BodyIndex FindChild(std::uint32_t root, const Vector &r) const;
+};
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_INFLUENCE_H_
@@ -0,0 +1,158 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "integrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace kin {
+
+
+// Dormand-Prince 5(4) coefficients. See Hairer, Norsett and Wanner,
+// "Solving Ordinary Differential Equations I", section II.5.
+static constexpr double kC2 = 1.0 / 5.0;
+static constexpr double kC3 = 3.0 / 10.0;
+static constexpr double kC4 = 4.0 / 5.0;
+static constexpr double kC5 = 8.0 / 9.0;
+static constexpr double kA21 = 1.0 / 5.0;
+static constexpr double kA31 = 3.0 / 40.0;
+static constexpr double kA32 = 9.0 / 40.0;
+static constexpr double kA41 = 44.0 / 45.0;
+static constexpr double kA42 = -56.0 / 15.0;
+static constexpr double kA43 = 32.0 / 9.0;
+static constexpr double kA51 = 19372.0 / 6561.0;
+static constexpr double kA52 = -25360.0 / 2187.0;
+static constexpr double kA53 = 64448.0 / 6561.0;
+static constexpr double kA54 = -212.0 / 729.0;
+static constexpr double kA61 = 9017.0 / 3168.0;
+static constexpr double kA62 = -355.0 / 33.0;
+static constexpr double kA63 = 46732.0 / 5247.0;
+static constexpr double kA64 = 49.0 / 176.0;
+static constexpr double kA65 = -5103.0 / 18656.0;
+static constexpr double kA71 = 35.0 / 384.0;
+static constexpr double kA73 = 500.0 / 1113.0;
+static constexpr double kA74 = 125.0 / 192.0;
+static constexpr double kA75 = -2187.0 / 6784.0;
+static constexpr double kA76 = 11.0 / 84.0;
+// Difference between fifth and fourth order weights.
+static constexpr double kE1 = 71.0 / 57600.0;
+static constexpr double kE3 = -71.0 / 16695.0;
+static constexpr double kE4 = 71.0 / 1920.0;
+static constexpr double kE5 = -17253.0 / 339200.0;
+static constexpr double kE6 = 22.0 / 525.0;
+static constexpr double kE7 = -1.0 / 40.0;
+// Continuous extension.
+static constexpr double kD1 = -12715105075.0 / 11282082432.0;
+static constexpr double kD3 = 87487479700.0 / 32700410799.0;
+static constexpr double kD4 = -10690763975.0 / 1880347072.0;
+static constexpr double kD5 = 701980252875.0 / 199316789632.0;
+static constexpr double kD6 = -1453857185.0 / 822651844.0;
+static constexpr double kD7 = 69997945.0 / 29380423.0;
+
+// Step size control.
+static constexpr double kSafetyFactor = 0.9;
+static constexpr double kMinStepFactor = 0.2;
+static constexpr double kMaxStepFactor = 10.0;
+static constexpr int kMaxRejectedSteps = 64;
+
+StateVector DenseStep::Interpolate(const double t) const {
+    const double theta = (t - t0_) / (t1_ - t0_);
+    const double theta1 = 1.0 - theta;
+    return coefficients_[0] + theta * (coefficients_[1] + theta1 * (
+        coefficients_[2] + theta * (
+            coefficients_[3] + theta1 * coefficients_[4])));
+}
+
+double DormandPrince::EstimateInitialStep(
+        const double t, const StateVector &y, const double max_step) const {
+    // Algorithm from Hairer, Norsett and Wanner, section II.4.
+    const StateVector f0 = f_(t, y);
+    const double d0 = ErrorNorm(y, y, y);
+    const double d1 = ErrorNorm(f0, y, y);
+    const double h0 = d0 < 1e-5 || d1 < 1e-5 ? 1e-6 : 0.01 * d0 / d1;
+    const StateVector f1 = f_(t + h0, y + h0 * f0);
+    const double d2 = ErrorNorm(f1 - f0, y, y) / h0;
+    const double d = std::max(d1, d2);
+    const double h1 = d <= 1e-15 ?
+        std::max(1e-6, h0 * 1e-3) : std::pow(0.01 / d, 1.0 / 5.0);
+    return std::min({100.0 * h0, h1, max_step});
+}
+
+DenseStep DormandPrince::Step(const double t, const StateVector &y,
+        const double max_step, double *step) const {
+    double h = std::min(*step, max_step);
+    const StateVector k1 = f_(t, y);
+    bool rejected = false;
+    for (int i = 0; i < kMaxRejectedSteps; ++i) {
+        const StateVector k2 = f_(t + kC2 * h, y + h * (kA21 * k1));
+        const StateVector k3 = f_(t + kC3 * h,
+            y + h * (kA31 * k1 + kA32 * k2));
+        const StateVector k4 = f_(t + kC4 * h,
+            y + h * (kA41 * k1 + kA42 * k2 + kA43 * k3));
+        const StateVector k5 = f_(t + kC5 * h,
+            y + h * (kA51 * k1 + kA52 * k2 + kA53 * k3 + kA54 * k4));
+        const StateVector k6 = f_(t + h, y + h * (
+            kA61 * k1 + kA62 * k2 + kA63 * k3 + kA64 * k4 + kA65 * k5));
+        const StateVector y1 = y + h * (
+            kA71 * k1 + kA73 * k3 + kA74 * k4 + kA75 * k5 + kA76 * k6);
+        const StateVector k7 = f_(t + h, y1);
+        const StateVector error = h * (kE1 * k1 + kE3 * k3 + kE4 * k4 +
+            kE5 * k5 + kE6 * k6 + kE7 * k7);
+        const double error_norm = ErrorNorm(error, y, y1);
+        const double factor = std::min(kMaxStepFactor, std::max(kMinStepFactor,
+            kSafetyFactor * std::pow(error_norm, -1.0 / 5.0)));
+        if (error_norm <= 1.0) {
+            DenseStep dense;
+            dense.t0_ = t;
+            dense.t1_ = t + h;
+            dense.y1_ = y1;
+            const StateVector dy = y1 - y;
+            const StateVector b = h * k1 - dy;
+            dense.coefficients_[0] = y;
+            dense.coefficients_[1] = dy;
+            dense.coefficients_[2] = b;
+            dense.coefficients_[3] = dy - h * k7 - b;
+            dense.coefficients_[4] = h * (kD1 * k1 + kD3 * k3 + kD4 * k4 +
+                kD5 * k5 + kD6 * k6 + kD7 * k7);
+            // Do not grow step immediately after a rejection.
+            *step = rejected ? std::min(h, h * factor) : h * factor;
+            return dense;
+        }
+        rejected = true;
+        h *= factor;
+    }
+    throw std::runtime_error("DormandPrince::Step() : "
+        "No step within tolerance found from t: " + std::to_string(t));
+}
+
+double DormandPrince::ErrorNorm(const StateVector &e,
+        const StateVector &y0, const StateVector &y1) const {
+    // Position and velocity are each scaled by the magnitude of the
+    // vector, rather than per element, so that the tolerance does not
+    // tighten as an element passes through zero.
+    const double position_scale = position_tolerance_ + relative_tolerance_ *
+        std::max(y0.head<3>().norm(), y1.head<3>().norm());
+    const double velocity_scale = velocity_tolerance_ + relative_tolerance_ *
+        std::max(y0.tail<3>().norm(), y1.tail<3>().norm());
+    return std::max(e.head<3>().norm() / position_scale,
+                    e.tail<3>().norm() / velocity_scale);
+}
+
+
+}  // namespace kin
@@ -0,0 +1,126 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_INTEGRATOR_H_
+#define ACTOR_SRC_INTEGRATOR_H_
+
+#include <functional>
+#include "vector.h"
+#include "util.h"
+
+namespace kin {
+
+
+/** Position (first three elements) and velocity of an object. */
+using StateVector = Eigen::Matrix<double, 6, 1>;
+
+inline StateVector MakeStateVector(const Vector &r, const Vector &v) {
+    StateVector y;
+    y << r, v;
+    return y;
+}
+
+inline KinematicData ToKinematicData(const StateVector &y) {
+    return {y.head<3>(), y.tail<3>()};
+}
+
+
+/**
+ * Single accepted step of a DormandPrince integrator, which can be
+ * evaluated at any time within the step (dense output) with the same
+ * order of accuracy as the step's end point.
+ */
+class DenseStep {
+ public:
+    DenseStep(): t0_(0.0), t1_(0.0) {}
+
+    /** Interpolates state at passed time within [t0, t1]. */
+    StateVector Interpolate(double t) const;
+
+    // getters
+    double t0() const { return t0_; }
+    double t1() const { return t1_; }
+    const StateVector& y1() const { return y1_; }
+
+ private:
+    double t0_;
+    double t1_;
+    StateVector y1_;
+    StateVector coefficients_[5];  // continuous extension coefficients
+
+    friend class DormandPrince;
+};
+
+
+/**
+ * Embedded Runge-Kutta integrator of the Dormand-Prince 5(4) pair,
+ * with step size control and dense output, for the motion of an
+ * object whose acceleration is given as a function of time, position
+ * and velocity.
+ *
+ * Each step's local error is estimated from the difference between
+ * the fifth and fourth order solutions, and steps are shrunk or
+ * grown to keep it near the configured tolerances.
+ */
+class DormandPrince {
+ public:
+    /** Returns derivative (velocity, acceleration) of passed state. */
+    using Derivative = std::function<StateVector(double, const StateVector&)>;
+
+    /**
+     * Tolerances are per step. Absolute tolerances are given for
+     * position (m) and velocity (m/s).
+     */
+    DormandPrince(Derivative f, double relative_tolerance,
+        double position_tolerance, double velocity_tolerance):
+            f_(f), relative_tolerance_(relative_tolerance),
+            position_tolerance_(position_tolerance),
+            velocity_tolerance_(velocity_tolerance) {}
+
+    /**
+     * Estimates a suitable size of the first step from state y at
+     * time t, no larger than max_step.
+     */
+    double EstimateInitialStep(double t, const StateVector &y,
+        double max_step) const;
+
+    /**
+     * Advances state y from time t by one accepted step. The step
+     * initially attempted is *step; it is reduced until the error
+     * estimate is within tolerance, and is no larger than max_step.
+     * On return, *step holds the size suggested for the next step.
+     */
+    DenseStep Step(double t, const StateVector &y, double max_step,
+        double *step) const;
+
+ private:
+    Derivative f_;
+    double relative_tolerance_;
+    double position_tolerance_;
+    double velocity_tolerance_;
+
+    /**
+     * Finds the larger of the position and velocity errors in e, each
+     * relative to its tolerance at states y0 and y1.
+     */
+    double ErrorNorm(const StateVector &e,
+        const StateVector &y0, const StateVector &y1) const;
+};
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_INTEGRATOR_H_
@@ -0,0 +1,200 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "kepler.h"
+
+#include <cmath>
+#include "const.h"
+
+namespace kin {
+
+
+static constexpr double    kPhysicsThresh  = 1e-12;
+static constexpr double    kRenderThresh   = 1e-7;
+static constexpr int       kMaxIterations  = 7;
+// Hyperbolic Halley iterations never exceed four from the starter
+// below for 1 < e <= 100 and M <= 1e5; this leaves headroom.
+static constexpr int       kMaxHalleyIterations = 6;
+static constexpr double    kNearParabolicEccentricity = 1.01;
+
+
+
+/**
+ * Evaluates E - e sin(E) (or e sinh(E) - E if e > 1, negated) as a
+ * series, avoiding the cancellation that occurs when e is near 1 and
+ * E is small.
+ */
+static double near_parabolic(const double E, const double e) {
+    const double anomaly_b = e > 1. ? E * E : -E * E;
+    double term = e * anomaly_b * E / 6.;
+    double r_val = (1. - e) * E - term;
+    int n = 4;
+
+    while (std::fabs(term) > 1e-15) {
+        term *= anomaly_b / (n * (n + 1));
+        r_val -= term;
+        n += 2;
+    }
+    return r_val;
+}
+
+/**
+ * Markley's starter for the elliptic case; accurate to ~5e-4 rad for
+ * 0 <= M <= PI and all e < 1.
+ *
+ * F. L. Markley, "Kepler Equation Solver", Celestial Mechanics and
+ * Dynamical Astronomy 63 (1995).
+ */
+static double elliptic_starter(const double e, const double M) {
+    const double alpha = (3. * PI * PI + 1.6 * PI * (PI - M) / (1. + e)) /
+        (PI * PI - 6.);
+    const double d = 3. * (1. - e) + alpha * e;
+    const double q = 2. * alpha * d * (1. - e) - M * M;
+    const double r = 3. * alpha * d * (d - 1. + e) * M + M * M * M;
+    const double w = std::pow(std::fabs(r) + std::sqrt(q * q * q + r * r),
+                              2. / 3.);
+    return (2. * r * w / (w * w + w * q + q * q) + M) / d;
+}
+
+/**
+ * Starter for the hyperbolic case. Solves the cubic approximation
+ * (e - 1)H + eH^3/6 = M where the result is small, and otherwise uses
+ * the asymptotic form H = ln(2M/e + 1.8).
+ */
+static double hyperbolic_starter(const double e, const double M) {
+    const double p = 6. * (e - 1.) / e;
+    const double q = 6. * M / e;
+    const double disc = std::sqrt(q * q / 4. + p * p * p / 27.);
+    const double H = std::cbrt(q / 2. + disc) + std::cbrt(q / 2. - disc);
+    return H > 1. ? std::log(2. * M / e + 1.8) : H;
+}
+
+static double solve_elliptic(const double e, const double mean_anomaly,
+        const KeplerTolerance tolerance) {
+    // Reduce to 0 <= M <= PI, using the symmetry E(-M) = -E(M).
+    const double reduced = std::remainder(mean_anomaly, TAU);
+    const double offset = mean_anomaly - reduced;
+    const double M = std::fabs(reduced);
+
+    const double E = elliptic_starter(e, M);
+    const double es = e * std::sin(E);
+    const double ec = e * std::cos(E);
+    const double f0 = e > .9 && E < 1. ?
+        near_parabolic(E, e) - M : E - es - M;
+    const double f1 = 1. - ec;
+    // A single Halley correction brings the starter to ~2e-11; the
+    // fifth-order correction used for physics reaches ~5e-16.
+    double delta = -f0 / (f1 - .5 * f0 * es / f1);
+    if (tolerance != kRenderTolerance) {
+        delta = -f0 / (f1 + .5 * delta * es + delta * delta * ec / 6.);
+        delta = -f0 / (f1 + .5 * delta * es + delta * delta * ec / 6. -
+            delta * delta * delta * es / 24.);
+    }
+    return reduced < 0. ? offset - (E + delta) : offset + E + delta;
+}
+
+/**
+ * Solves Barker's equation M = D + D^3 / 3 for D = tan(t / 2), in
+ * closed form.
+ */
+static double solve_parabolic(const double mean_anomaly) {
+    return 2. * std::sinh(std::asinh(1.5 * mean_anomaly) / 3.);
+}
+
+static double solve_hyperbolic(const double e, const double mean_anomaly,
+        const KeplerTolerance tolerance, int *iterations) {
+    const double M = std::fabs(mean_anomaly);
+    const double thresh = AnomalyThreshold(tolerance);
+    double H = hyperbolic_starter(e, M);
+    int n_iter = 0;
+    while (n_iter < kMaxHalleyIterations) {
+        // sinh and cosh from a single exponential.
+        const double exp_h = std::exp(H);
+        const double sinh_h = .5 * (exp_h - 1. / exp_h);
+        const double cosh_h = .5 * (exp_h + 1. / exp_h);
+        const double f0 = e < kNearParabolicEccentricity && H < 1. ?
+            -near_parabolic(H, e) - M : e * sinh_h - H - M;
+        const double f1 = e * cosh_h - 1.;
+        const double delta = -f0 / (f1 - .5 * f0 * e * sinh_h / f1);
+        H += delta;
+        ++n_iter;
+        if (std::fabs(delta) <= thresh * std::fmax(1., H)) {
+            break;
+        }
+    }
+    if (iterations != nullptr) {
+        *iterations = n_iter;
+    }
+    return mean_anomaly < 0. ? -H : H;
+}
+
+
+double AnomalyThreshold(const KeplerTolerance tolerance) {
+    return tolerance == kRenderTolerance ? kRenderThresh : kPhysicsThresh;
+}
+
+double SolveKepler(const double e, const double mean_anomaly,
+        const KeplerTolerance tolerance, int *iterations) {
+    if (iterations != nullptr) {
+        *iterations = 0;
+    }
+    if (!mean_anomaly) {
+        return 0.;
+    }
+    if (e < 1.) {
+        if (iterations != nullptr) {
+            *iterations = 1;
+        }
+        return solve_elliptic(e, mean_anomaly, tolerance);
+    } else if (e == 1.) {
+        return solve_parabolic(mean_anomaly);
+    }
+    return solve_hyperbolic(e, mean_anomaly, tolerance, iterations);
+}
+
+double SolveKeplerFrom(const double e, const double mean_anomaly,
+        const double anomaly_guess, const KeplerTolerance tolerance,
+        int *iterations) {
+    // Residual tolerance is relative to the size of the mean anomaly,
+    // which may be large for hyperbolic orbits.
+    const double thresh =
+        AnomalyThreshold(tolerance) * std::fmax(1., std::fabs(mean_anomaly));
+    double curr = anomaly_guess;
+    for (int n_iter = 0; n_iter <= kMaxIterations; ++n_iter) {
+        double err, slope;
+        if (e < 1.) {
+            err = curr - e * std::sin(curr) - mean_anomaly;
+            slope = 1. - e * std::cos(curr);
+        } else {
+            err = e * std::sinh(curr) - curr - mean_anomaly;
+            slope = e * std::cosh(curr) - 1.;
+        }
+        if (std::fabs(err) <= thresh) {
+            if (iterations != nullptr) {
+                *iterations = n_iter;
+            }
+            return curr;
+        }
+        curr -= err / slope;
+    }
+    // Guess was too far from the solution for Newton's method to
+    // converge quickly; solve from scratch instead.
+    return SolveKepler(e, mean_anomaly, tolerance, iterations);
+}
+
+
+}  // namespace kin
@@ -0,0 +1,75 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_KEPLER_H_
+#define ACTOR_SRC_KEPLER_H_
+
+namespace kin {
+
+
+/**
+ * Precision to which Kepler's equation is solved.
+ *
+ * kPhysicsTolerance resolves the anomaly to ~1e-12 rad or better, and
+ * is used for all state propagation. kRenderTolerance resolves it to
+ * ~1e-7 rad, which is well below what can be displayed, at a lower
+ * cost.
+ */
+enum KeplerTolerance {
+    kPhysicsTolerance, kRenderTolerance
+};
+
+/**
+ * Gets the convergence threshold, in radians of anomaly, used for
+ * the passed tolerance.
+ */
+double AnomalyThreshold(const KeplerTolerance tolerance);
+
+/**
+ * Solves Kepler's equation for the eccentric anomaly (e < 1) or the
+ * hyperbolic anomaly (e > 1) corresponding to the passed mean anomaly.
+ * If e == 1, Barker's equation M = D + D^3 / 3 is solved for
+ * D = tan(t / 2) instead.
+ *
+ * Elliptic orbits use Markley's starter followed by a single
+ * correction whose order depends on the tolerance. Hyperbolic orbits
+ * use Halley's method, and are bounded to a small, fixed number of
+ * iterations. The parabolic case is solved in closed form.
+ *
+ * If iterations is not null, the number of iterations used is
+ * written to it.
+ */
+double SolveKepler(const double e, const double mean_anomaly,
+    const KeplerTolerance tolerance = kPhysicsTolerance,
+    int *iterations = nullptr);
+
+/**
+ * Solves Kepler's equation using Newton's method, starting from the
+ * passed estimate of the anomaly rather than from a generic starter.
+ *
+ * Intended for use when a solution at a nearby mean anomaly is
+ * already known. Falls back to SolveKepler() if the estimate does not
+ * converge within a few iterations.
+ */
+double SolveKeplerFrom(const double e, const double mean_anomaly,
+    const double anomaly_guess,
+    const KeplerTolerance tolerance = kPhysicsTolerance,
+    int *iterations = nullptr);
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_KEPLER_H_
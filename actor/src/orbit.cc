@@ -7,20 +7,31 @@
 
 #include <cmath>
 #include "const.h"
+#include "kepler.h"
+#include "universal.h"
 
 
 namespace kin {
 
-// Forward declarations
-static double kepler(const double e, double mean_anomaly);
-
-
 // Constructors -------------------------------------------------------
 
 Orbit::Orbit(const Body &ref,
     double a, double e, double i, double l, double w, double t):
-    u(ref.gm()), a(a), e(e), i(i), l(l), w(w), t(t),
-    transforms_initialized_(false) {}
+    Orbit(ref.gm(), a, e, i, l, w, t) {
+}
+
+Orbit::Orbit(
+    double u, double a, double e, double i, double l, double w, double t):
+    u(u), a(a), e(e), i(i), l(l), w(w), t(t),
+    r0_(Vector::Zero()), v0_(Vector::Zero()),
+    transforms_initialized_(false) {
+    // The semi-latus rectum of a parabolic orbit is found from its
+    // angular momentum, which elements alone do not provide.
+    if (e == 1.0) {
+        throw std::invalid_argument("Orbit::Orbit() : "
+            "Parabolic orbits (e == 1) cannot be created from elements.");
+    }
+}
 
 Orbit::Orbit(const Body &ref, const Vector r, const Vector v):
     Orbit(ref.gm(), r, v) {
@@ -38,6 +49,24 @@ Orbit::Orbit(double u, const Vector r, const Vector v): u(u), r0_(r), v0_(v) {
 
 // Getters ------------------------------------------------------------
 
+double Orbit::periapsis() const {
+    if (e == 1.0) {
+        return semiparameter() / 2;
+    }
+    return a * (1.0 - e);
+}
+
+/**
+ * Gets the semi-latus rectum. For parabolic orbits, where a is
+ * infinite, this is found from the specific angular momentum instead.
+ */
+double Orbit::semiparameter() const {
+    if (e == 1.0) {
+        return r0_.cross(v0_).squaredNorm() / u;
+    }
+    return a * (1 - e * e);
+}
+
 double Orbit::semi_minor_axis() const {
     return std::sqrt(a * a * (1 - e * e));
 }
@@ -51,8 +80,13 @@ double Orbit::period() const {
 }
 
 double Orbit::mean_motion() const {
-    if (e >= 1.0) {
-        return mean_anomaly() / time_since_periapsis();
+    if (e == 1.0) {
+        // Parabolic mean motion, such that Barker's equation takes
+        // the form M = D + D^3 / 3.
+        const double p = semiparameter();
+        return 2 * std::sqrt(u / (p * p * p));
+    } else if (e > 1.0) {
+        return std::sqrt(u / (-a * -a * -a));
     }
     return std::sqrt(u / (a*a*a));
 }
@@ -61,8 +95,7 @@ double Orbit::time_since_periapsis() const {
     if (e > 1.0) {
         return std::sqrt(-a * -a * -a / u) * mean_anomaly();
     } else if (e == 1.0) {
-        // TODO
-        throw std::runtime_error("NOT IMPLEMENTED L61");
+        return mean_anomaly() / mean_motion();
     }
     // If elliptical:
     return mean_anomaly() / mean_motion();
@@ -113,8 +146,11 @@ double Orbit::mean_anomaly() const {
         }
     } else if (e > 1.0) {
         M = e * std::sinh(E) - E;
+    } else if (e == 1.0) {
+        M = E + E * E * E / 3;  // Barker's equation
     } else {
-        throw std::runtime_error("NOT IMPLEMENTED L115");
+        throw std::runtime_error("Orbit::mean_anomaly() : "
+            "Not implemented for e: " + std::to_string(e));
     }
     return M;
 }
@@ -123,70 +159,39 @@ double Orbit::mean_anomaly() const {
  * Gets Current position vector in orbit.
  */
 Vector Orbit::position() const {
-    const double ea = eccentric_anomaly();
-    double p, q;
-    // Generate positions in orbital plane.
-    if (0.0 < e && e < 1.0) {
-        p = a * (std::cos(ea) - e);
-        q = a * std::sin(ea) * std::sqrt(1 - std::pow(e, 2));
-    } else {
-        double r;
-        if (e > 1.0) {
-            const double semi_latus = a * (1.0 - e * e);
-            r = semi_latus / (1.0 + e * cos(t));
-        } else if (e == 1.0) {
-            // TODO
-            throw std::runtime_error("NOT IMPLEMENTED L124");
-        } else if (e == 0.0) {
-            r = a;
-        } else {
-            throw std::runtime_error("Orbit::position() : "
-                "Invalid e: " + std::to_string(e));
-        }
-        p = std::cos(t) * r;
-        q = std::sin(t) * r;
-    }
-    Vector untransformed_position(p, q, 0);
-
-    // Transform position
-    if (!transforms_initialized_) {
-        CalculateTransform(untransformed_position);
-    }
-    const Vector in_plane_r = plane_transform_ * untransformed_position;
-    return periapsis_transform_ * in_plane_r;
+    return kinematic_data().r;
 }
 
 /**
  * Gets Current velocity vector in orbit.
  */
 Vector Orbit::velocity() const {
-    const double ea = eccentric_anomaly();
-    // Transform velocity into 3d space.
-    const double distance = a * (1 - e * std::cos(ea));
-    Vector untransformed_v;
-    if (0.0 < e && e < 1.0) {
-        untransformed_v = std::sqrt(u * a) / distance * Vector(
-            - std::sin(ea),  // vp
-            std::sqrt(1 - e * e) * std::cos(ea),  // vq
-            0);
-    } else if (e > 1.0) {
-        const double dist = a * (1 - e * e) / (1 + e * std::cos(t));
-        const double phi = std::atan(e * std::sin(t) / (1 + e * std::cos(t)));
-        const double angle = t + PI / 2 - phi;
-        untransformed_v = std::sqrt(u * (2 / dist - 1 / a)) * Vector(
-            std::cos(angle),
-            std::sin(angle),
-            0);
-        // throw std::runtime_error("NOT IMPLEMENTED L171");
-    } else {
-        throw std::runtime_error("NOT IMPLEMENTED L172");
+    return kinematic_data().v;
+}
+
+/**
+ * Gets current position and velocity vectors in orbit.
+ *
+ * Both vectors are produced from a single evaluation of the current
+ * anomaly, so callers that need both should prefer this method to
+ * separate calls to position() and velocity().
+ */
+KinematicData Orbit::kinematic_data() const {
+    const KinematicData perifocal = perifocal_kinematic_data();
+    if (!transforms_initialized_) {
+        CalculateTransform(perifocal.r);
     }
-    // Transform velocity
+    return {
+        periapsis_transform_ * (plane_transform_ * perifocal.r),
+        periapsis_transform_ * (plane_transform_ * perifocal.v)
+    };
+}
+
+Matrix Orbit::perifocal_transform() const {
     if (!transforms_initialized_) {
         CalculateTransform();
     }
-    const Vector in_plane_v = plane_transform_ * untransformed_v;
-    return periapsis_transform_ * in_plane_v;
+    return periapsis_transform_ * plane_transform_;
 }
 
 // Other Methods ------------------------------------------------------
@@ -240,24 +245,35 @@ void Orbit::CalcFromPosVel(const Vector r, const Vector v) {
  * https://en.wikipedia.org/wiki/True_anomaly
  */
 void Orbit::CalcTrueAnomaly(const double eccentric_anomaly) {
+    this->t = FindTrueAnomaly(eccentric_anomaly);
+}
+
+double Orbit::FindTrueAnomaly(const double eccentric_anomaly) const {
     if (std::isnan(eccentric_anomaly)) {
-        throw std::invalid_argument("Orbit::CalcTrueAnomaly passed NaN.");
+        throw std::invalid_argument("Orbit::FindTrueAnomaly passed NaN.");
     }
     const double E = eccentric_anomaly;
+    double t;
     if (0.0 < e && e < 1.0) {
-        this->t = std::acos((std::cos(E) - e) / (1 - e * std::cos(E)));
-        if (eccentric_anomaly > PI && this->t < PI) {
-            this->t = 2*PI - this->t;
+        t = std::acos((std::cos(E) - e) / (1 - e * std::cos(E)));
+        if (eccentric_anomaly > PI && t < PI) {
+            t = 2*PI - t;
         }
     } else if (e > 1.0) {
-        this->t =
-            2 * std::atan(std::sqrt((e + 1) / (e - 1)) * std::tanh(E / 2));
+        t = 2 * std::atan(std::sqrt((e + 1) / (e - 1)) * std::tanh(E / 2));
         if (eccentric_anomaly < 0) {
-            this->t = 2*PI + this->t;
+            t = 2*PI + t;
+        }
+    } else if (e == 1.0) {
+        t = 2 * std::atan(E);
+        if (t < 0) {
+            t = 2*PI + t;
         }
     } else {
-        throw std::runtime_error("NOT IMPLEMENTED L230");
+        throw std::runtime_error("Orbit::FindTrueAnomaly() : "
+            "Not implemented for e: " + std::to_string(e));
     }
+    return t;
 }
 
 double Orbit::EstimateTrueAnomaly(const double mean_anomaly) const {
@@ -277,13 +293,14 @@ double Orbit::EstimateTrueAnomaly(const double mean_anomaly) const {
     return t;
 }
 
-double Orbit::CalcEccentricAnomaly(const double mean_anomaly) const {
+double Orbit::CalcEccentricAnomaly(
+        const double mean_anomaly, const KeplerTolerance tolerance) const {
     // This method is used to determine the eccentric anomaly at a
     // point in time in the future, and (usually) not the current time.
     if (std::isnan(mean_anomaly)) {
         throw std::invalid_argument("Orbit::CalcEccentricAnomaly passed NaN.");
     }
-    const double eccentric_anomaly = kepler(e, mean_anomaly);
+    const double eccentric_anomaly = SolveKepler(e, mean_anomaly, tolerance);
     if (std::isnan(eccentric_anomaly)) {
         throw std::invalid_argument("Orbit::CalcEccentricAnomaly : "
             "has invalid values.");
@@ -299,26 +316,60 @@ void Orbit::CalculateTransform(const Vector untransformed_position) const {
         const Vector r2 = plane_transform_ * untransformed_position;
         periapsis_transform_ = Quaternion().setFromTwoVectors(r2, r0_);
     } else {
-        throw std::runtime_error("Transform from elements not yet supported");
+        // Orbit was created from elements; rotate the plane by
+        // inclination and ascending node, then rotate periapsis
+        // about the orbit normal by its argument.
+        const Quaternion plane =
+            Eigen::AngleAxisd(l, Vector::UnitZ()) *
+            Eigen::AngleAxisd(i, Vector::UnitX());
+        plane_transform_ = plane;
+        periapsis_transform_ = Quaternion(
+            Eigen::AngleAxisd(w, plane * Vector::UnitZ()));
     }
     transforms_initialized_ = true;
 }
 
 void Orbit::CalculateTransform() const {
-    // Roundabout + inefficient but simple way to ensure things are
-    // initialized.
-    // position() calls CalculateTransform in its implementation.
-    position();
+    CalculateTransform(perifocal_kinematic_data().r);
 }
 
 double Orbit::SpeedAtDistance(const double distance) const {
     return std::sqrt(u * (2 / distance - 1 / a));
 }
 
-void Orbit::Step(const double time) {
-    if (!transforms_initialized_) {
-        position();  // Initialize values before moving if they are not already.
+/**
+ * Gets current position and velocity in the perifocal frame;
+ * the orbital plane, with periapsis lying along the x axis.
+ */
+KinematicData Orbit::perifocal_kinematic_data() const {
+    return PerifocalKinematicData(t);
+}
+
+/**
+ * Gets position and velocity in the perifocal frame at the passed
+ * true anomaly.
+ */
+KinematicData Orbit::PerifocalKinematicData(const double true_anomaly) const {
+    if (!(e >= 0.0)) {
+        throw std::runtime_error("Orbit::PerifocalKinematicData() : "
+            "Invalid e: " + std::to_string(e));
     }
+    const double sin_t = std::sin(true_anomaly);
+    const double cos_t = std::cos(true_anomaly);
+    const double semi_latus = semiparameter();
+    const double distance = semi_latus / (1.0 + e * cos_t);
+    const double speed_factor = std::sqrt(u / semi_latus);
+    return {
+        Vector(distance * cos_t, distance * sin_t, 0),
+        Vector(-speed_factor * sin_t, speed_factor * (e + cos_t), 0)
+    };
+}
+
+/**
+ * Finds mean anomaly at passed time relative to the current position
+ * in orbit.
+ */
+double Orbit::FindMeanAnomaly(const double time) const {
     double M = mean_anomaly();
     M += mean_motion() * time;
 
@@ -329,144 +380,61 @@ void Orbit::Step(const double time) {
             M = TAU + M;
         }
     }
+    return M;
+}
 
+void Orbit::Step(const double time, const KeplerTolerance tolerance) {
+    if (!transforms_initialized_) {
+        position();  // Initialize values before moving if they are not already.
+    }
     // calculate true anomaly
-    const double E = CalcEccentricAnomaly(M);
+    const double E = CalcEccentricAnomaly(FindMeanAnomaly(time), tolerance);
     CalcTrueAnomaly(E);
 }
 
-Orbit Orbit::Predict(const double time) const {
+/**
+ * Predicts state of orbit after passed time, without modifying or
+ * copying the orbit.
+ */
+OrbitState Orbit::PredictState(
+        const double time, const KeplerTolerance tolerance) const {
+    if (!transforms_initialized_) {
+        CalculateTransform();
+    }
+    OrbitState state;
+    state.mean_anomaly = FindMeanAnomaly(time);
+    state.eccentric_anomaly = CalcEccentricAnomaly(
+        state.mean_anomaly, tolerance);
+    state.true_anomaly = FindTrueAnomaly(state.eccentric_anomaly);
+    const KinematicData perifocal = PerifocalKinematicData(state.true_anomaly);
+    state.r = periapsis_transform_ * (plane_transform_ * perifocal.r);
+    state.v = periapsis_transform_ * (plane_transform_ * perifocal.v);
+    return state;
+}
+
+KinematicData Orbit::PredictKinematicData(
+        const double time, const KeplerTolerance tolerance) const {
+    const KinematicData current = kinematic_data();
+    return UniversalPropagator(u, current.r, current.v).Predict(
+        time, tolerance);
+}
+
+Orbit Orbit::Predict(
+        const double time, const KeplerTolerance tolerance) const {
     if (!transforms_initialized_) {
-        position();  // Cache values that may be copied
         // Since a single orbit may be copied many times, it
         // is best to calculate anything that can be cached once,
         // and then give that data to all copies, than to have each
         // copy calculate things for themselves.
+        CalculateTransform();
     }
     // Create copy of self and advance.
     // Copy elision optimization should occur.
     Orbit prediction = *this;
-    prediction.Step(time);
-    prediction.plane_transform_ = plane_transform_;
-    prediction.periapsis_transform_ = periapsis_transform_;
+    prediction.t = FindTrueAnomaly(
+        CalcEccentricAnomaly(FindMeanAnomaly(time), tolerance));
     return prediction;
 }
 
 
-// FUNCTIONS FOR SOLVING KEPLER'S EQUATION
-
-
-static constexpr double    kThresh         = 1e-12;
-static constexpr double    kMinThresh      = 1e-14;
-static constexpr int       kMaxIterations  = 7;
-static constexpr double    kNearParabolicEccentricity = 1.01;
-
-
-static double near_parabolic(const double E, const double e) {
-    const double anomaly_b = e > 1. ? E * E : -E * E;
-    double term = e * anomaly_b * E / 6.;
-    double r_val = (1. - e) * E - term;
-    int n = 4;
-
-    while (std::fabs(term) > 1e-15) {
-        term *= anomaly_b / (n * (n + 1));
-        r_val -= term;
-        n += 2;
-    }
-    return r_val;
-}
-
-
-static double kepler(const double e, double mean_anomaly) {
-    double curr, err, thresh, offset = 0.;
-    double delta_curr = 1.;
-    bool is_negative = false;
-    int n_iter = 0;
-
-    if (!mean_anomaly) {
-        return( 0.);
-    }
-
-    if (e < 1.0) {
-        if (mean_anomaly < -PI || mean_anomaly > PI) {
-            double tmod = std::fmod(mean_anomaly, PI * 2.);
-
-            if (tmod > PI) {
-                tmod -= 2. * PI;
-            } else if (tmod < -PI) {
-                tmod += 2. * PI;
-            }
-            offset = mean_anomaly - tmod;
-            mean_anomaly = tmod;
-        }
-
-        if (e < .9) {  // Meeus' low-eccentricity method.
-            curr = std::atan2(sin(mean_anomaly), cos(mean_anomaly) - e);
-            // Make corrections.
-            do {
-                err = (curr - e * std::sin(curr) - mean_anomaly) /
-                    (1. - e * std::cos(curr));
-                curr -= err;
-            } while (std::fabs(err) > kThresh);
-            return curr + offset;
-        }
-    }
-
-    if (mean_anomaly < 0.) {
-        mean_anomaly = -mean_anomaly;
-        is_negative = true;
-    }
-
-    curr = mean_anomaly;
-    thresh = kThresh * std::fabs(1. - e);
-    // Due to round-off error, there's no way to
-    // go below a certain minimum threshold.
-    if (thresh < kMinThresh) {
-        thresh = kMinThresh;
-    }
-    if (e > 1. && mean_anomaly / e > 3.) {  // Hyperbolic, large-mean-anomaly
-        curr = log(mean_anomaly / e) + 0.85;
-    } else if ((e > .8 && mean_anomaly < PI / 3.) || e > 1.) {  // Up to 60d.
-        double trial = mean_anomaly / std::fabs(1. - e);
-
-        if (trial * trial > 6. * std::fabs(1. - e)) {
-            trial = std::cbrt(6. * mean_anomaly);
-        }
-        curr = trial;
-        if (thresh > kThresh) {  // Happens when e > 2.
-            thresh = kThresh;
-        }
-    }
-
-    if (e < 1.) {
-        while (std::fabs(delta_curr) > thresh) {
-            if (n_iter++ > kMaxIterations) {
-                err = near_parabolic(curr, e) - mean_anomaly;
-            } else {
-                err = curr - e * std::sin(curr) - mean_anomaly;
-            }
-            delta_curr = -err / (1. - e * cos(curr));
-            curr += delta_curr;
-            if (n_iter > kMaxIterations * 2) {
-                throw std::runtime_error("Runaway iteration");
-            }
-        }
-    } else {
-        while (std::fabs(delta_curr) > thresh) {
-            if (n_iter++ > kMaxIterations && e < kNearParabolicEccentricity) {
-                err = -near_parabolic(curr, e) - mean_anomaly;
-            } else {
-                err = e * std::sinh(curr) - curr - mean_anomaly;
-            }
-            delta_curr = -err / (e * std::cosh(curr) - 1.);
-            curr += delta_curr;
-            if (n_iter > kMaxIterations * 2) {
-                throw std::runtime_error("Runaway iteration");
-            }
-        }
-    }
-    return is_negative ? offset - curr : offset + curr;
-}
-
-
 }  // namespace kin
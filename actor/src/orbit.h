@@ -30,6 +30,7 @@
 
 #include <memory>
 #include "body.h"
+#include "kepler.h"
 #include "vector.h"
 #include "util.h"
 
@@ -44,11 +45,15 @@ class Body;
 
 class Orbit {
  public:
+    /**
+     * Creates orbit from orbital elements. Parabolic orbits (e == 1)
+     * have no finite semi-major axis, and must be created from
+     * position and velocity instead.
+     */
     Orbit(const Body &ref,
         double a, double e, double i, double l, double w, double t);
 
-    Orbit(double u, double a, double e, double i, double l, double w, double t):
-        u(u), a(a), e(e), i(i), l(l), w(w), t(t) {}
+    Orbit(double u, double a, double e, double i, double l, double w, double t);
 
     Orbit(const Body &ref, const Vector r, const Vector v);
 
@@ -58,14 +63,14 @@ class Orbit {
 
     double gravitational_parameter() const { return u; }
     double semi_major_axis() const { return a; }
-    double periapsis() const { return a * (1.0 - e); }
+    double periapsis() const;
     double apoapsis() const { return a * (1.0 + e); }
     double eccentricity() const { return e; }
     double inclination() const { return i; }
     double longitude_of_ascending_node() const { return l; }
     double argument_of_periapsis() const { return w; }
     double true_anomaly() const { return t; }
-    double semiparameter() const { return a * (1 - e * e); }
+    double semiparameter() const;
     double semi_minor_axis() const;
     double period() const;
     double eccentric_anomaly() const;
@@ -76,10 +81,29 @@ class Orbit {
     double max_speed() const;
     Vector position() const;
     Vector velocity() const;
-    KinematicData kinematic_data() const { return {position(), velocity()}; }
-
-    void Step(const double time);
-    Orbit Predict(const double time) const;
+    /**
+     * Gets rotation from the perifocal frame (periapsis along x,
+     * orbit normal along z) into the frame of the reference body.
+     */
+    Matrix perifocal_transform() const;
+    KinematicData kinematic_data() const;
+
+    /**
+     * Advance or predict orbit by passed time. The tolerance selects
+     * the precision of the Kepler solve; see KeplerTolerance.
+     */
+    void Step(const double time,
+        const KeplerTolerance tolerance = kPhysicsTolerance);
+    Orbit Predict(const double time,
+        const KeplerTolerance tolerance = kPhysicsTolerance) const;
+    OrbitState PredictState(const double time,
+        const KeplerTolerance tolerance = kPhysicsTolerance) const;
+    /**
+     * Predicts position and velocity after passed time using
+     * universal variables; a single code path for all values of e.
+     */
+    KinematicData PredictKinematicData(const double time,
+        const KeplerTolerance tolerance = kPhysicsTolerance) const;
 
  protected:
     double u, a, e, i, l, w, t;
@@ -95,8 +119,13 @@ class Orbit {
     // For small eccentricities a good approximation of true anomaly can be
     // obtained by the following formula (the error is of the order e^3)
     double EstimateTrueAnomaly(const double mean_anomaly) const;
-    double CalcEccentricAnomaly(const double mean_anomaly) const;
+    double CalcEccentricAnomaly(const double mean_anomaly,
+        const KeplerTolerance tolerance = kPhysicsTolerance) const;
     double SpeedAtDistance(const double distance) const;
+    KinematicData perifocal_kinematic_data() const;
+    KinematicData PerifocalKinematicData(const double true_anomaly) const;
+    double FindMeanAnomaly(const double time) const;
+    double FindTrueAnomaly(const double eccentric_anomaly) const;
     void CalcTrueAnomaly(const double eccentric_anomaly);
 };
 
@@ -16,12 +16,15 @@
 
 #include "path.h"
 
-#include <iterator>
 #include <vector>
 #include <utility>  // pair
 #include <stdexcept>
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include "const.h"
 #include "system.h"
+#include "universal.h"
 
 namespace kin {
 
@@ -29,6 +32,198 @@ namespace kin {
 static constexpr double kMaxOrbitPeriodDurationPerStep      = 0.01;
 static constexpr double kMinBallisticStepDuration           = 15.0;
 static constexpr double kMaxMassRatioChangePerStep          = 0.001;
+static constexpr double kEventTimeTolerance                 = 1e-3;
+static constexpr int kMaxEventIterations                    = 64;
+static constexpr double kIntegratorRelativeTolerance        = 1e-8;
+static constexpr double kIntegratorPositionTolerance        = 1.0;  // m
+static constexpr double kIntegratorVelocityTolerance        = 1e-3;  // m/s
+static constexpr double kEnckeRectificationRatio            = 0.01;
+static constexpr double kMaxTessellationAnomaly             = PI / 4;
+static constexpr int kMinManeuverTessellationParts          = 4;
+static constexpr int kMaxTessellationDepth                  = 24;
+
+/**
+ * Finds acceleration due to thrust of passed maneuver at time t, for
+ * position and velocity relative to the maneuver's reference body.
+ *
+ * Mass is found here rather than from FindMassAtTime(), so that the
+ * rounding of integrator stage times cannot trip its range check.
+ */
+static Vector FindThrustAcceleration(const Maneuver &maneuver,
+        const Vector &rel_r, const Vector &rel_v, const double t) {
+    const double m = maneuver.m0() -
+        (t - maneuver.t0()) * maneuver.performance().flow_rate();
+    return maneuver.FindThrustVector(rel_r, rel_v) *
+        (maneuver.performance().thrust() / m);
+}
+
+/**
+ * Finds the step containing time t among passed steps in the range
+ * [first, end), which are contiguous and in order of time. Steps
+ * ending at t are preferred, and the last step is used if t is
+ * beyond it.
+ */
+template <typename Steps>
+static const DenseStep& FindStep(const Steps &steps,
+        const std::size_t first, const std::size_t end, const double t) {
+    typename Steps::const_iterator step = std::lower_bound(
+        steps.begin() + first, steps.begin() + end, t,
+        [](const DenseStep &step, const double t) { return step.t1() < t; });
+    if (step == steps.begin() + end) {
+        --step;
+    }
+    return *step;
+}
+
+/** Point of a polyline, at parameter p of the curve it follows. */
+struct PolylineVertex {
+    double p;
+    double t;
+    Vector r;
+};
+
+/**
+ * Finds distance of point r from the line between a and b.
+ */
+static double FindChordError(
+        const Vector &a, const Vector &b, const Vector &r) {
+    const Vector chord = b - a;
+    const double length2 = chord.squaredNorm();
+    if (length2 == 0.0) {
+        return (r - a).norm();
+    }
+    const double s = std::min(1.0, std::max(0.0, (r - a).dot(chord) / length2));
+    return (a + chord * s - r).norm();
+}
+
+/**
+ * Appends vertices of a polyline following a curve from first,
+ * exclusive, to last, splitting each line in half (in the parameter
+ * of the curve) until the curve's midpoint, found by passed function,
+ * is within tolerance of it.
+ */
+template <typename Evaluate>
+static void Subdivide(const PolylineVertex &first, const PolylineVertex &last,
+        const double tolerance, const Evaluate &evaluate,
+        std::vector<Vector> *vertices, std::vector<double> *times) {
+    // Ends of lines still to be checked, with their depth of division;
+    // the next line to check runs from the current vertex to the top.
+    std::vector<std::pair<PolylineVertex, int> > ends = {{last, 0}};
+    PolylineVertex current = first;
+    while (!ends.empty()) {
+        std::pair<PolylineVertex, int> &end = ends.back();
+        if (end.second < kMaxTessellationDepth) {
+            const PolylineVertex middle = evaluate((current.p + end.first.p) / 2);
+            if (FindChordError(current.r, end.first.r, middle.r) > tolerance) {
+                const int depth = ++end.second;
+                ends.emplace_back(middle, depth);
+                continue;
+            }
+        }
+        current = end.first;
+        vertices->push_back(current.r);
+        if (times != nullptr) {
+            times->push_back(current.t);
+        }
+        ends.pop_back();
+    }
+}
+
+/**
+ * Finds unwrapped true anomaly of a conic of eccentricity e from its
+ * eccentric (or hyperbolic) anomaly, and the reverse. Elliptic
+ * anomalies of later revolutions remain greater than earlier ones.
+ */
+static double FindTrueAnomaly(const double e, const double anomaly) {
+    if (e > 1.0) {
+        return 2 * std::atan(std::sqrt((e + 1) / (e - 1)) *
+                             std::tanh(anomaly / 2));
+    }
+    const double revolutions = std::floor((anomaly + PI) / TAU);
+    return 2 * std::atan(std::sqrt((1 + e) / (1 - e)) *
+        std::tan((anomaly - revolutions * TAU) / 2)) + revolutions * TAU;
+}
+
+static double FindEccentricAnomaly(const double e, const double true_anomaly) {
+    if (e > 1.0) {
+        return 2 * std::atanh(std::sqrt((e - 1) / (e + 1)) *
+                              std::tan(true_anomaly / 2));
+    }
+    const double revolutions = std::floor((true_anomaly + PI) / TAU);
+    return 2 * std::atan(std::sqrt((1 - e) / (1 + e)) *
+        std::tan((true_anomaly - revolutions * TAU) / 2)) + revolutions * TAU;
+}
+
+/**
+ * Finds time at which passed event function first becomes <= 0
+ * within the interval [t0, t1], given that it is <= 0 at t1.
+ *
+ * The crossing is refined using the Illinois variant of regula falsi
+ * until the bracket is narrower than kEventTimeTolerance. The
+ * returned time is always one at which the event function is <= 0.
+ * If the event function is already <= 0 at t0, no crossing occurs
+ * within the interval, and t1 is returned.
+ */
+template <typename EventFunction>
+static double FindEventCrossing(
+        const EventFunction &f, double t0, double t1) {
+    double f0 = f(t0);
+    if (f0 <= 0.0) {
+        return t1;
+    }
+    double f1 = f(t1);
+    int retained = 0;  // Side retained by last iteration; -1: t0, 1: t1
+    for (int i = 0; i < kMaxEventIterations && t1 - t0 > kEventTimeTolerance;
+            ++i) {
+        double t = (t0 * f1 - t1 * f0) / (f1 - f0);
+        if (!(t0 < t && t < t1)) {
+            t = (t0 + t1) / 2.0;  // Fall back to bisection.
+        }
+        const double ft = f(t);
+        if (ft > 0.0) {
+            t0 = t;
+            f0 = ft;
+            if (retained == 1) {
+                f1 /= 2.0;
+            }
+            retained = 1;
+        } else {
+            t1 = t;
+            f1 = ft;
+            if (retained == -1) {
+                f0 /= 2.0;
+            }
+            retained = -1;
+        }
+    }
+    return t1;
+}
+
+// OrbitData methods --------------------------------------------------
+
+
+OrbitData::OrbitData(const Orbit orbit, const Body &body):
+        OrbitData(body, orbit.kinematic_data(), orbit) {}
+
+OrbitData::OrbitData(
+        const Body &body, const KinematicData &data, const Orbit &orbit):
+        body_(body), r_(data.r), v_(data.v),
+        orbit_(std::make_shared<const Orbit>(orbit)) {}
+
+const Orbit& OrbitData::orbit() const {
+    std::shared_ptr<const Orbit> orbit = std::atomic_load(&orbit_);
+    if (!orbit) {
+        // If another thread found the orbit first, its orbit is kept,
+        // so that references returned earlier remain valid.
+        std::shared_ptr<const Orbit> found =
+            std::make_shared<const Orbit>(body_, r_, v_);
+        if (std::atomic_compare_exchange_strong(&orbit_, &orbit, found)) {
+            orbit = found;
+        }
+    }
+    return *orbit;
+}
+
 
 // Maneuver methods ---------------------------------------------------
 
@@ -38,7 +233,8 @@ Maneuver::Maneuver(ManeuverType type,
                    const PerformanceData performance,
                    double m0,
                    double t0):
-        type_(type), dv_(dv), performance_(performance), m0_(m0), t0_(t0) {}
+        type_(type), dv_(dv), performance_(performance), m0_(m0), t0_(t0),
+        propagation_(kConstantAcceleration) {}
 
 Maneuver::Maneuver(const Vector vector,
                    double dv,
@@ -46,7 +242,8 @@ Maneuver::Maneuver(const Vector vector,
                    double m0,
                    double t0):
         type_(kFixed), fixed_vector_(vector),
-        dv_(dv), performance_(performance), m0_(m0), t0_(t0) {}
+        dv_(dv), performance_(performance), m0_(m0), t0_(t0),
+        propagation_(kConstantAcceleration) {}
 
 double Maneuver::mass_fraction() const {
     return 1 - std::pow(constants::e, -dv_ / performance_.ve());
@@ -75,10 +272,12 @@ double Maneuver::FindMassAtTime(const double t) const {
 
 Vector Maneuver::FindThrustVector(
         const Body &ref, const Vector r, const Vector v, const double t) const {
-    const Vector body_r = ref.PredictSystemPosition(t);
-    const Vector body_v = ref.PredictSystemVelocity(t);
-    const Vector rel_r = r - body_r;
-    const Vector rel_v = v - body_v;
+    const KinematicData body_data = ref.PredictSystemKinematicData(t);
+    return FindThrustVector(r - body_data.r, v - body_data.v);
+}
+
+Vector Maneuver::FindThrustVector(
+        const Vector rel_r, const Vector rel_v) const {
     switch (type_) {
         case kPrograde:
             return rel_v.normalized();
@@ -103,7 +302,7 @@ Vector Maneuver::FindThrustVector(
 
 FlightPath::FlightPath(
     const System &system, const Vector r, const Vector v, double t):
-        system_(system), r0_(r), v0_(v), t0_(t) {
+        system_(system), r0_(r), v0_(v), t0_(t), impulse_ratio_(0.0) {
     if (t < 0) {
         throw std::invalid_argument("FlightPath::FlightPath() : "
             "Passed value t (" + std::to_string(t) + ") was < 0");
@@ -118,7 +317,77 @@ FlightPath::FlightPath(
 }
 
 KinematicData FlightPath::Predict(const double time) const {
-    return GetSegment(time).Predict(time);
+    return GetGroup(time).Predict(time);
+}
+
+void FlightPath::PredictAt(const double * const times, const std::size_t n,
+                           Vector * const r, Vector * const v) const {
+    Cursor(*this).PredictAt(times, n, r, v);
+}
+
+void FlightPath::Tessellate(
+        const double t0, const double t1, const double tolerance,
+        std::vector<Vector> * const vertices,
+        std::vector<double> * const times) const {
+    if (t0 < t0_ || t1 < t0) {
+        throw std::invalid_argument("FlightPath::Tessellate() : "
+            "Passed times (" + std::to_string(t0) + ", " +
+            std::to_string(t1) + ") were out of order, or preceded the "
+            "start of FlightPath (" + std::to_string(t0_) + ")");
+    }
+    if (tolerance <= 0.0) {
+        throw std::invalid_argument("FlightPath::Tessellate() : "
+            "Passed tolerance (" + std::to_string(tolerance) + ") was <= 0");
+    }
+    vertices->clear();
+    if (times != nullptr) {
+        times->clear();
+    }
+    Calculate(t1);
+    const Timeline<SegmentGroup*> &groups = cache_.groups;
+    std::size_t group_index = groups.UpperBound(t0) - 1;
+    std::size_t segment_index =
+        groups[group_index]->segments().UpperBound(t0) - 1;
+    const SegmentGroup &first_group = *groups[group_index];
+    vertices->push_back(first_group.Predict(
+        first_group.segments()[segment_index], t0).r);
+    if (times != nullptr) {
+        times->push_back(t0);
+    }
+    // Each segment is followed until the next segment or group begins.
+    double t = t0;
+    while (t < t1) {
+        const SegmentGroup &group = *groups[group_index];
+        const Timeline<Segment, ArenaAllocator<Segment> > &segments =
+            group.segments();
+        const bool last_segment = segment_index + 1 == segments.size();
+        const double end_t = std::min(t1, !last_segment ?
+            segments.t(segment_index + 1) : group_index + 1 < groups.size() ?
+            groups.t(group_index + 1) : t1);
+        if (end_t > t) {
+            group.Tessellate(segments[segment_index], t, end_t, tolerance,
+                             vertices, times);
+            t = end_t;
+        }
+        if (!last_segment) {
+            ++segment_index;
+        } else if (group_index + 1 < groups.size()) {
+            ++group_index;
+            segment_index = 0;
+        }
+    }
+}
+
+void FlightPath::PredictRange(
+        const double t0, const double t1, const std::size_t n,
+        std::vector<Vector> * const r, std::vector<Vector> * const v) const {
+    std::vector<double> times(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        times[i] = n == 1 ? t0 : t0 + (t1 - t0) * i / (n - 1);
+    }
+    r->resize(n);
+    v->resize(n);
+    PredictAt(times.data(), n, r->data(), v->data());
 }
 
 OrbitData FlightPath::PredictOrbit(
@@ -126,44 +395,39 @@ OrbitData FlightPath::PredictOrbit(
     // If passed reference body is null, use body within
     // sphere of influence.
     if (body == nullptr) {
-        return GetSegment(time).PredictOrbit(time);
+        return GetGroup(time).PredictOrbit(time);
     } else {
         // Produce orbit from current system position and velocity.
         const KinematicData kinematics = Predict(time);
         // Find position and velocity relative to reference body.
-        const Vector rel_r = kinematics.r - body->PredictSystemPosition(time);
-        const Vector rel_v = kinematics.v - body->PredictSystemVelocity(time);
-        // Produce orbit from relative position, velocity, and body.
-        return OrbitData(Orbit(*body, rel_r, rel_v), *body);
+        const KinematicData body_data = body->PredictSystemKinematicData(time);
+        const Vector rel_r = kinematics.r - body_data.r;
+        const Vector rel_v = kinematics.v - body_data.v;
+        // Orbital elements are only found if requested.
+        return OrbitData(*body, rel_r, rel_v);
     }
 }
 
 const Maneuver* FlightPath::FindManeuver(const double t) const {
-    if (maneuvers_.size() == 0) {
+    const std::size_t following_index = maneuvers_.UpperBound(t);
+    // If no previous maneuver exists, return nullptr
+    if (following_index == 0) {
         return nullptr;
     }
-    auto following_iterator = maneuvers_.upper_bound(t);
-    // If no previous iterator exists, return nullptr
-    if (following_iterator == maneuvers_.begin()) {
-        return nullptr;
-    }
-    // Get iterator of maneuver preceding or equal to time t
-    const Maneuver &preceding_maneuver = *std::prev(following_iterator)->second;
+    // Get maneuver preceding or equal to time t
+    const Maneuver &preceding_maneuver = *maneuvers_[following_index - 1];
     // If maneuver has ended by or at time t, return nullptr,
     // otherwise ptr to maneuver.
     return preceding_maneuver.t1() <= t ? nullptr : &preceding_maneuver;
 }
 
 const Maneuver* FlightPath::FindNextManeuver(const double t) const {
-    if (maneuvers_.size() == 0) {
-        return nullptr;
-    }
-    auto following_iterator = maneuvers_.upper_bound(t);
-    // If no following iterator exists, return nullptr
-    if (following_iterator == maneuvers_.end()) {
+    const std::size_t following_index = maneuvers_.UpperBound(t);
+    // If no following maneuver exists, return nullptr
+    if (following_index == maneuvers_.size()) {
         return nullptr;
     }
-    return following_iterator->second.get();
+    return maneuvers_[following_index].get();
 }
 
 void FlightPath::Add(const Maneuver &maneuver) {
@@ -174,7 +438,7 @@ void FlightPath::Add(const Maneuver &maneuver) {
             "Passed maneuver had null address.");
     }
     if (maneuvers_.size() > 0) {
-        const Maneuver &last = *std::prev(maneuvers_.end())->second;
+        const Maneuver &last = *maneuvers_.back();
         if (last.t1() > maneuver.t0()) {
             throw std::invalid_argument("FlightPath::Add() : "
                 "Passed Maneuver has t0 (" + std::to_string(maneuver.t0()) +
@@ -182,33 +446,71 @@ void FlightPath::Add(const Maneuver &maneuver) {
                 "FlightPath (tf: " + std::to_string(last.t1()) + ")");
         }
     }
-    maneuvers_[maneuver.t0()] = std::make_unique<Maneuver>(maneuver);  // Copy.
-    ClearCache();  // Reset calculated data (calculated segments, etc).
+    // Only the path following the added maneuver's start changes.
+    ClearCacheAfter(maneuver.t0());
+    // Maneuvers follow all existing ones, so are always appended.
+    maneuvers_.Append(maneuver.t0(), std::make_unique<Maneuver>(maneuver));
 }
 
 bool FlightPath::Clear() {
-    maneuvers_.clear();
-    ClearCache();  // Reset calculated data (calculated segments, etc).
+    if (!maneuvers_.empty()) {
+        ClearCacheAfter(maneuvers_.t(0));
+    }
+    maneuvers_.Clear();
     return true;
 }
 
 bool FlightPath::ClearAfter(const double t) {
     // Clear maneuvers that begin after, but not at time t.
     const std::size_t initial_size = maneuvers_.size();
-    std::map<double, std::unique_ptr<Maneuver> >::iterator first =
-        maneuvers_.upper_bound(t);
-    maneuvers_.erase(first, maneuvers_.end());
-    ClearCache();  // Reset calculated data (calculated segments, etc).
+    const std::size_t following_index = maneuvers_.UpperBound(t);
+    if (following_index < maneuvers_.size()) {
+        ClearCacheAfter(maneuvers_.t(following_index));
+    }
+    maneuvers_.Truncate(following_index);
     return maneuvers_.size() == initial_size;
 }
 
 bool FlightPath::Remove(const Maneuver &maneuver) {
     const std::size_t initial_size = maneuvers_.size();
-    maneuvers_.erase(maneuver.t0());
-    ClearCache();  // Reset calculated data (calculated segments, etc).
+    const std::size_t following_index = maneuvers_.UpperBound(maneuver.t0());
+    if (following_index > 0 &&
+            maneuvers_.t(following_index - 1) == maneuver.t0()) {
+        ClearCacheAfter(maneuver.t0());
+        maneuvers_.Erase(following_index - 1);
+    }
     return maneuvers_.size() == initial_size;
 }
 
+KinematicData FlightPath::FindImpulseError(const Maneuver &maneuver) const {
+    const std::size_t following_index = maneuvers_.UpperBound(maneuver.t0());
+    if (following_index == 0 ||
+            maneuvers_.t(following_index - 1) != maneuver.t0()) {
+        throw std::invalid_argument("FlightPath::FindImpulseError() : "
+            "Passed maneuver (t0: " + std::to_string(maneuver.t0()) +
+            ") is not in FlightPath");
+    }
+    const Maneuver &path_maneuver = *maneuvers_[following_index - 1];
+    const KinematicData start = Predict(path_maneuver.t0());
+    if (!IsImpulsive(path_maneuver, start.r, start.v)) {
+        throw std::invalid_argument("FlightPath::FindImpulseError() : "
+            "Passed maneuver (t0: " + std::to_string(maneuver.t0()) +
+            ") is not treated as impulsive");
+    }
+    Maneuver finite = path_maneuver;
+    finite.set_propagation(Maneuver::kIntegrated);
+    ManeuverSegmentGroup finite_group(
+        system_, &finite, start.r, start.v, finite.t0());
+    const CalculationStatus finite_status = finite_group.Calculate(finite.t1());
+    const KinematicData end = Predict(finite.t1());
+    return {end.r - finite_status.r, end.v - finite_status.v};
+}
+
+void FlightPath::set_impulse_ratio(const double ratio) {
+    impulse_ratio_ = ratio;
+    ClearCache();  // Reset calculated data (calculated segments, etc).
+}
+
 
 // Private methods
 
@@ -236,50 +538,108 @@ void FlightPath::Calculate(const double t) const {
     while (cache_.status.end_t <= t) {
         // Get maneuver (if any) that new SegmentGroup will
         // correspond with.
-        const Maneuver * const maneuver = FindManeuver(cache_.status.end_t);
+        const Maneuver *maneuver = FindManeuver(cache_.status.end_t);
         const Vector r = cache_.status.r;
-        const Vector v = cache_.status.v;
+        Vector v = cache_.status.v;
         const double group_t = cache_.status.end_t;
-        std::unique_ptr<SegmentGroup> group;
+        const SegmentGroup * const previous = last_group();
+        if (maneuver != nullptr && previous != nullptr &&
+                previous->maneuver() == maneuver) {
+            // The previous group coasted to the midpoint of an
+            // impulsive maneuver, whose delta-V is applied here.
+            const Body &primary = system_.FindPrimaryInfluence(r, group_t);
+            v += maneuver->FindThrustVector(primary, r, v, group_t) *
+                maneuver->dv();
+            maneuver = nullptr;
+        }
+        Arena &arena = cache_.arena;
+        SegmentGroup *group;
         if (maneuver == nullptr) {
             const Maneuver * const next_maneuver = FindNextManeuver(
                     cache_.status.end_t);
             const double group_tf = next_maneuver == nullptr ?
                     -1.0 : next_maneuver->t0();
-            group = std::make_unique<BallisticSegmentGroup>(
-                system_, r, v, group_t, group_tf);
+            group = arena.Create<BallisticSegmentGroup>(
+                system_, r, v, group_t, group_tf, nullptr, &arena);
+        } else if (IsImpulsive(*maneuver, r, v)) {
+            // Coast until the midpoint of the burn.
+            group = arena.Create<BallisticSegmentGroup>(
+                system_, r, v, group_t, maneuver->mid_t(), maneuver, &arena);
         } else {
-            group = std::make_unique<ManeuverSegmentGroup>(
-                system_, maneuver, r, v, group_t);
+            group = arena.Create<ManeuverSegmentGroup>(
+                system_, maneuver, r, v, group_t, &arena);
         }
+        cache_.groups.Append(group_t, group);
         cache_.status = group->Calculate(t);
-        cache_.groups[group_t] = std::move(group);
     }
 }
 
-const FlightPath::Segment& FlightPath::GetSegment(const double t) const {
+const FlightPath::SegmentGroup& FlightPath::GetGroup(const double t) const {
     // validate t
     if (t < t0_) {
         throw std::invalid_argument(
-            "FlightPath::GetSegment() passed invalid time: " +
+            "FlightPath::GetGroup() passed invalid time: " +
             std::to_string(t) + " FlightPath begins at " + std::to_string(t0_));
     }
     // calculate segments for path until time t
     Calculate(t);
     // Get segment group for time t.
-    SegmentGroup &group = *std::prev(cache_.groups.upper_bound(t))->second;
+    return *cache_.groups[cache_.groups.UpperBound(t) - 1];
+}
+
+const FlightPath::Segment& FlightPath::GetSegment(const double t) const {
     // Get segment immediately before, or starting at time t.
-    return group.GetSegment(t);
+    return GetGroup(t).GetSegment(t);
 }
 
 void FlightPath::ClearCache() const {
-    cache_ = FlightPath::FlightPathCache();
+    // Groups are destroyed with the arena's reset, which keeps its
+    // memory for the groups calculated next.
+    cache_.groups.Clear();
+    cache_.arena.Reset();
+    cache_.n_discarded_groups = 0;
     cache_.status = FlightPath::CalculationStatus(r0_, v0_, t0_);
 }
 
+void FlightPath::ClearCacheAfter(const double t) const {
+    Timeline<SegmentGroup*> &groups = cache_.groups;
+    // Find number of groups to keep; the group in effect at t is
+    // kept if it can be ended at t.
+    std::size_t n_kept = groups.UpperBound(t);
+    if (n_kept > 0 && !groups[n_kept - 1]->Truncate(t)) {
+        --n_kept;
+    }
+    // Discarded groups are only released when the arena is reset, so
+    // once more groups have been discarded than are kept, the cache
+    // is cleared in full rather than letting the arena keep growing.
+    const std::size_t n_discarded = groups.size() - n_kept;
+    if (n_kept == 0 || cache_.n_discarded_groups + n_discarded > n_kept) {
+        ClearCache();
+        return;
+    }
+    cache_.n_discarded_groups += n_discarded;
+    groups.Truncate(n_kept);
+    cache_.status = groups.back()->calculation_status();
+}
+
+bool FlightPath::IsImpulsive(
+        const Maneuver &maneuver, const Vector r, const Vector v) const {
+    if (maneuver.propagation() == Maneuver::kImpulsive) {
+        return true;
+    }
+    if (impulse_ratio_ <= 0.0) {
+        return false;
+    }
+    const Body &primary = system_.FindPrimaryInfluence(r, maneuver.t0());
+    const KinematicData body_data =
+        primary.PredictSystemKinematicData(maneuver.t0());
+    const double period = FindCharacteristicPeriod(
+        primary.gm(), r - body_data.r, v - body_data.v);
+    return maneuver.duration() <= period * impulse_ratio_;
+}
+
 FlightPath::SegmentGroup* FlightPath::last_group() const {
-    return cache_.groups.size() == 0 ?
-        nullptr : &(*cache_.groups.rbegin()->second);
+    return cache_.groups.empty() ? nullptr : cache_.groups.back();
 }
 
 FlightPath::CalculationStatus FlightPath::calculation_status() const {
@@ -294,9 +654,83 @@ FlightPath::CalculationStatus FlightPath::calculation_status() const {
 
 // FlightPath inner-classes -------------------------------------------
 
-// Segment ------------------------------------------------------------
+// Cursor -------------------------------------------------------------
+
+FlightPath::Cursor::Cursor(const FlightPath &path):
+        path_(path), group_bound_(0), segment_bound_(0) {}
+
+KinematicData FlightPath::Cursor::Predict(const double t) {
+    Seek(t);
+    const SegmentGroup &group = *path_.cache_.groups[group_bound_ - 1];
+    return group.Predict(group.segments()[segment_bound_ - 1], t);
+}
+
+OrbitData FlightPath::Cursor::PredictOrbit(const double t) {
+    Seek(t);
+    const SegmentGroup &group = *path_.cache_.groups[group_bound_ - 1];
+    return group.PredictOrbit(group.segments()[segment_bound_ - 1], t);
+}
+
+void FlightPath::Cursor::PredictAt(
+        const double * const times, const std::size_t n,
+        Vector * const r, Vector * const v) {
+    if (n == 0) {
+        return;
+    }
+    const std::pair<const double*, const double*> bounds =
+        std::minmax_element(times, times + n);
+    if (*bounds.first < path_.t0_) {
+        throw std::invalid_argument("FlightPath::Cursor::PredictAt() : "
+            "Passed time (" + std::to_string(*bounds.first) + ") precedes "
+            "start of FlightPath (" + std::to_string(path_.t0_) + ")");
+    }
+    // Calculating the path through the latest time first allows each
+    // segment's times to be found in a single run.
+    path_.Calculate(*bounds.second);
+    const Timeline<SegmentGroup*> &groups = path_.cache_.groups;
+    std::size_t i = 0;
+    while (i < n) {
+        Seek(times[i]);
+        const SegmentGroup &group = *groups[group_bound_ - 1];
+        const Timeline<Segment, ArenaAllocator<Segment> > &segments =
+            group.segments();
+        // Segment is in effect until the next segment or group begins,
+        // or, if it is the last calculated, until the calculation end.
+        const double start_t = segments.t(segment_bound_ - 1);
+        const double end_t = segment_bound_ < segments.size() ?
+            segments.t(segment_bound_) : group_bound_ < groups.size() ?
+            groups.t(group_bound_) : path_.cache_.status.end_t;
+        std::size_t end = i + 1;
+        while (end < n && times[end] >= start_t && times[end] < end_t) {
+            ++end;
+        }
+        group.Predict(segments[segment_bound_ - 1],
+                      times + i, end - i, r + i, v + i);
+        i = end;
+    }
+}
 
-FlightPath::Segment::Segment(
+void FlightPath::Cursor::Seek(const double t) {
+    if (t < path_.t0_) {
+        throw std::invalid_argument("FlightPath::Cursor::Seek() : "
+            "Passed time (" + std::to_string(t) + ") precedes start of "
+            "FlightPath (" + std::to_string(path_.t0_) + ")");
+    }
+    path_.Calculate(t);
+    const std::size_t group_bound =
+        path_.cache_.groups.UpperBound(t, group_bound_);
+    if (group_bound != group_bound_) {
+        // Times entering a group most often begin at its first segment.
+        group_bound_ = group_bound;
+        segment_bound_ = 1;
+    }
+    segment_bound_ = path_.cache_.groups[group_bound_ - 1]->segments()
+        .UpperBound(t, segment_bound_);
+}
+
+// SegmentCalculator --------------------------------------------------
+
+FlightPath::SegmentCalculator::SegmentCalculator(
         const System &system, const Vector r, const Vector v, double t):
     system_(system),
     primary_body_(system.FindPrimaryInfluence(r, t)),
@@ -304,20 +738,29 @@ FlightPath::Segment::Segment(
     v0_(v),
     t0_(t) {}
 
-void FlightPath::Segment::CheckPredictionTime(const double t) const {
+void FlightPath::SegmentCalculator::CheckPredictionTime(const double t) const {
     if (t < 0) {
         throw std::invalid_argument(
-            "FlightPath::Segment::CheckPredictionTime() : Passed t: " +
-            std::to_string(t));
+            "FlightPath::SegmentCalculator::CheckPredictionTime() : "
+            "Passed t: " + std::to_string(t));
     }
     if (t < t0_) {
         throw std::invalid_argument(
-            "FlightPath::Segment::CheckPredictionTime() : "
+            "FlightPath::SegmentCalculator::CheckPredictionTime() : "
             "Passed t preceded start time of segment. t: " + std::to_string(t) +
             "start: " + std::to_string(t0_));
     }
 }
 
+FlightPath::Segment FlightPath::SegmentCalculator::CreateSegment(
+        const Segment::Kind kind) const {
+    Segment segment;
+    segment.t0 = t0_;
+    segment.primary = system_.hierarchy().IndexOf(primary_body_);
+    segment.kind = kind;
+    return segment;
+}
+
 // ManeuverSegment ----------------------------------------------------
 
 FlightPath::ManeuverSegment::ManeuverSegment(
@@ -325,38 +768,29 @@ FlightPath::ManeuverSegment::ManeuverSegment(
         const Maneuver &maneuver,
         const Vector r,
         const Vector v,
-        double t):
-    Segment(system, r, v, t),
+        double t,
+        double step,
+        SegmentData *data):
+    SegmentCalculator(system, r, v, t),
     maneuver_(maneuver),
-    m0_(maneuver.FindMassAtTime(t)) {}
-
-KinematicData FlightPath::ManeuverSegment::Predict(const double t) const {
-    CheckPredictionTime(t);
-    Calculate(t);
-    // CheckPredictionTime only checks that t does not precede segment.
-    if (t >= calculation_status_.end_t) {
-        throw std::invalid_argument("FlightPath::ManeuverSegment::Predict() : "
-            "Passed t was >= end time of segment. t: " + std::to_string(t) +
-            " end: " + std::to_string(calculation_status_.end_t));
-    }
-    // A number of approximations are made here that reduce the
-    // accuracy of the result, but which simplify the code,
-    // and are faster to evaluate.
-    // If accuracy becomes an issue, this method should be re-written.
-    const double rel_t = t - t0_;
-    const Vector r = r0_ + a_ * (std::pow(rel_t, 2) / 2);
-    const Vector v = v0_ + a_ * rel_t;
-    return {r, v};
-}
-
-OrbitData FlightPath::ManeuverSegment::PredictOrbit(const double t) const {
-    // Predict system-relative position and velocity.
-    const KinematicData kinematics = Predict(t);
-    // Find position and velocity relative to reference body.
-    const Vector rel_r = kinematics.r - primary_body_.PredictSystemPosition(t);
-    const Vector rel_v = kinematics.v - primary_body_.PredictSystemVelocity(t);
-    // Produce and return orbit data.
-    return OrbitData(Orbit(primary_body_, rel_r, rel_v), primary_body_);
+    m0_(maneuver.FindMassAtTime(t)),
+    data_(data),
+    first_step_(static_cast<std::uint32_t>(data->steps.size())),
+    step_(step) {}
+
+FlightPath::Segment FlightPath::ManeuverSegment::segment() const {
+    if (maneuver_.propagation() == Maneuver::kIntegrated) {
+        Segment segment = CreateSegment(Segment::kIntegrated);
+        segment.steps = {first_step_, 1, 0};
+        return segment;
+    }
+    Segment segment = CreateSegment(Segment::kConstantAcceleration);
+    for (int i = 0; i < 3; ++i) {
+        segment.acceleration.r0[i] = r0_[i];
+        segment.acceleration.v0[i] = v0_[i];
+        segment.acceleration.a[i] = a_[i];
+    }
+    return segment;
 }
 
 FlightPath::CalculationStatus
@@ -386,18 +820,29 @@ FlightPath::CalculationStatus
     if (t < calculation_status_.end_t) {
         return calculation_status_;
     }
-    const Orbit initial_orbit(primary_body_, r0_, v0_);
+    if (maneuver_.propagation() == Maneuver::kIntegrated) {
+        if (calculation_status_.end_t > t0_) {
+            return calculation_status_;  // Segment is a single step.
+        }
+        return calculation_status_ = Integrate();
+    }
     // Attempt to determine when segment ends.
 
-    const double duration_limit = [this, initial_orbit]() -> double {
+    const double duration_limit = [this]() -> double {
         // Check first for duration in which maximum mass ratio
         // change occurs.
         const double delta_m = maneuver_.m0() * kMaxMassRatioChangePerStep;
         const double mass_limited_duration =
             delta_m / maneuver_.performance().flow_rate();
-        // Check max duration of step allowed by ratio of orbital period.
-        const double period_limited_duration =
-            initial_orbit.period() * kMaxOrbitPeriodDurationPerStep;
+        // Check max duration of step allowed by ratio of orbital period,
+        // found from the state relative to the primary body without
+        // calculating orbital elements. If trajectory is unbound, the
+        // period-equivalent 2 PI / mean motion is used.
+        const KinematicData body_data =
+            primary_body_.PredictSystemKinematicData(t0_);
+        const double period_limited_duration = FindCharacteristicPeriod(
+            primary_body_.gm(), r0_ - body_data.r, v0_ - body_data.v) *
+            kMaxOrbitPeriodDurationPerStep;
         // Use smaller of the two duration limits.
         return std::min(mass_limited_duration, period_limited_duration);
     }();
@@ -438,11 +883,161 @@ FlightPath::CalculationStatus
     // Set approximate acceleration used in segment.
     a_ = gravity_a + thrust_a;
     // Compute values needed in returned CalculationStatus.
-    const Vector rf = r0_ + a_ / 2 * std::pow(duration, 2);
+    const Vector rf = r0_ + v0_ * duration + a_ / 2 * std::pow(duration, 2);
     const Vector vf = v0_ + a_ * duration;
     return calculation_status_ = CalculationStatus(rf, vf, tf, false);
 }
 
+FlightPath::CalculationStatus FlightPath::ManeuverSegment::Integrate() const {
+    // The state relative to the primary body is integrated under the
+    // primary's gravity and the thrust of the maneuver; as with
+    // BallisticSegment, other bodies are ignored.
+    //
+    // Each segment is a single step of the integrator, so the
+    // segment's length is set by the error estimate rather than
+    // by fixed limits; its dense output is used for prediction.
+    const double gm = primary_body_.gm();
+    const Maneuver &maneuver = maneuver_;
+    const DormandPrince::Derivative f = [gm, &maneuver](
+            const double t, const StateVector &y) -> StateVector {
+        const Vector r = y.head<3>();
+        const Vector v = y.tail<3>();
+        const Vector a = r * (-gm / std::pow(r.norm(), 3)) +
+            FindThrustAcceleration(maneuver, r, v, t);
+        StateVector derivative;
+        derivative << v, a;
+        return derivative;
+    };
+    const DormandPrince integrator(f, kIntegratorRelativeTolerance,
+        kIntegratorPositionTolerance, kIntegratorVelocityTolerance);
+    const KinematicData body_data =
+        primary_body_.PredictSystemKinematicData(t0_);
+    const StateVector y0 =
+        MakeStateVector(r0_ - body_data.r, v0_ - body_data.v);
+    const double max_step = maneuver_.t1() - t0_;
+    if (step_ <= 0.0) {
+        step_ = integrator.EstimateInitialStep(t0_, y0, max_step);
+    }
+    data_->steps.push_back(integrator.Step(t0_, y0, max_step, &step_));
+    const DenseStep &dense_step = data_->steps.back();
+    // A step ending at the end of the maneuver is moved there
+    // exactly, so that the maneuver's group is not left with a sliver.
+    const double tf = dense_step.t1() >= maneuver_.t1() - kEventTimeTolerance ?
+        maneuver_.t1() : dense_step.t1();
+    const KinematicData rel = ToKinematicData(tf == dense_step.t1() ?
+        dense_step.y1() : dense_step.Interpolate(tf));
+    const KinematicData body_data1 =
+        primary_body_.PredictSystemKinematicData(tf);
+    return CalculationStatus(
+        rel.r + body_data1.r, rel.v + body_data1.v, tf, false);
+}
+
+// EnckeSegment -------------------------------------------------------
+
+FlightPath::EnckeSegment::EnckeSegment(
+        const System &system,
+        const Maneuver &maneuver,
+        const Vector r,
+        const Vector v,
+        double t,
+        double step,
+        SegmentData *data):
+    SegmentCalculator(system, r, v, t),
+    maneuver_(maneuver),
+    reference_(primary_body_.gm(),
+               r - primary_body_.PredictSystemPosition(t),
+               v - primary_body_.PredictSystemKinematicData(t).v),
+    integrator_([this](const double t, const StateVector &deviation) {
+                    return FindDeviationDerivative(t, deviation);
+                },
+                kIntegratorRelativeTolerance,
+                kIntegratorPositionTolerance,
+                kIntegratorVelocityTolerance),
+    data_(data),
+    first_step_(static_cast<std::uint32_t>(data->steps.size())),
+    reference_index_(static_cast<std::uint32_t>(data->references.size())),
+    step_(step),
+    calculation_complete_(false) {
+    data_->references.push_back(reference_);
+}
+
+FlightPath::Segment FlightPath::EnckeSegment::segment() const {
+    Segment segment = CreateSegment(Segment::kEncke);
+    segment.steps = {first_step_,
+        static_cast<std::uint32_t>(data_->steps.size()) - first_step_,
+        reference_index_};
+    return segment;
+}
+
+FlightPath::CalculationStatus
+        FlightPath::EnckeSegment::Calculate(const double t) const {
+    if (t < calculation_status_.end_t || calculation_complete_) {
+        return calculation_status_;
+    }
+    auto &steps = data_->steps;
+    double step_t = t0_;
+    StateVector deviation = StateVector::Zero();
+    if (steps.size() > first_step_) {
+        step_t = steps.back().t1();
+        deviation = steps.back().y1();
+    } else if (step_ <= 0.0) {
+        step_ = integrator_.EstimateInitialStep(
+            t0_, deviation, maneuver_.t1() - t0_);
+    }
+    while (step_t <= t && !calculation_complete_) {
+        steps.push_back(integrator_.Step(
+            step_t, deviation, maneuver_.t1() - step_t, &step_));
+        step_t = steps.back().t1();
+        deviation = steps.back().y1();
+        if (step_t >= maneuver_.t1() - kEventTimeTolerance) {
+            // Moved to the end of the maneuver exactly, so that the
+            // maneuver's group is not left with a sliver.
+            step_t = maneuver_.t1();
+            calculation_complete_ = true;
+        } else if (deviation.head<3>().norm() > kEnckeRectificationRatio *
+                reference_.Predict(step_t - t0_).r.norm()) {
+            // Deviation is large enough that the reference conic no
+            // longer describes the trajectory well; the next segment
+            // starts from a new one.
+            calculation_complete_ = true;
+        }
+    }
+    const KinematicData system_data = PredictLocal(step_t) +
+        primary_body_.PredictSystemKinematicData(step_t);
+    return calculation_status_ =
+        CalculationStatus(system_data.r, system_data.v, step_t, false);
+}
+
+KinematicData FlightPath::EnckeSegment::PredictLocal(const double t) const {
+    const DenseStep &step =
+        FindStep(data_->steps, first_step_, data_->steps.size(), t);
+    return reference_.Predict(t - t0_) + ToKinematicData(step.Interpolate(t));
+}
+
+StateVector FlightPath::EnckeSegment::FindDeviationDerivative(
+        const double t, const StateVector &deviation) const {
+    // With reference position p, deviation d and position r = p + d,
+    // the difference in gravitational acceleration at r and p is
+    // found using Battin's formulation, which avoids subtracting
+    // two nearly equal accelerations:
+    //   q = d.(d - 2r) / r^2
+    //   f(q) = (|p|/|r|)^3 - 1 = q (3 + 3q + q^2) / (1 + (1 + q)^1.5)
+    //   d'' = -gm / |p|^3 (d + f(q) r) + thrust
+    const KinematicData reference = reference_.Predict(t - t0_);
+    const Vector d = deviation.head<3>();
+    const Vector r = reference.r + d;
+    const Vector v = reference.v + deviation.tail<3>();
+    const double q = d.dot(d - 2.0 * r) / r.squaredNorm();
+    const double f = q * (3.0 + 3.0 * q + q * q) /
+        (1.0 + std::pow(1.0 + q, 1.5));
+    const Vector a = (d + r * f) *
+        (-primary_body_.gm() / std::pow(reference.r.norm(), 3)) +
+        FindThrustAcceleration(maneuver_, r, v, t);
+    StateVector derivative;
+    derivative << deviation.tail<3>(), a;
+    return derivative;
+}
+
 // BallisticSegment ---------------------------------------------------
 
 FlightPath::BallisticSegment::BallisticSegment(
@@ -450,27 +1045,37 @@ FlightPath::BallisticSegment::BallisticSegment(
         const Vector r,
         const Vector v,
         double t):
-            Segment(system, r, v, t),
-            orbit_(primary_body_, r, v) {}
+            SegmentCalculator(system, r, v, t),
+            orbit_([this, r, v, t]() {
+                // Orbit is relative to primary body.
+                const KinematicData body_data =
+                    primary_body_.PredictSystemKinematicData(t);
+                return Orbit(primary_body_, r - body_data.r, v - body_data.v);
+            }()),
+            packed_(OrbitEphemeris(orbit_).Pack()),
+            ephemeris_(packed_) {
+    const double primary_soi =
+        system_.hierarchy().sphere_of_influence(
+            system_.hierarchy().IndexOf(primary_body_));
+    // The root body's influence is unbounded.
+    may_exit_ = primary_soi > 0.0 &&
+        (orbit_.eccentricity() >= 1.0 || orbit_.apoapsis() >= primary_soi);
+    FindReachablePeers();
+}
 
 KinematicData FlightPath::BallisticSegment::Predict(const double t) const {
     // Ensure that t does not come before segment.
     CheckPredictionTime(t);
-    Orbit prediction = orbit_.Predict(t - t0_);
     // Produce system-relative kinematics by adding orbit
     // r and v, to body's system-relative r and v.
-    KinematicData kinematics;
-    kinematics.r = prediction.position() +
-        primary_body_.PredictSystemPosition(t);
-    kinematics.v = prediction.velocity() +
-        primary_body_.PredictSystemVelocity(t);
-    return kinematics;
+    return ephemeris_.Predict(t - t0_) +
+        primary_body_.PredictSystemKinematicData(t);
 }
 
-OrbitData FlightPath::BallisticSegment::PredictOrbit(const double t) const {
-    CheckPredictionTime(t);
-    const Orbit prediction = orbit_.Predict(t - t0_);
-    return OrbitData(prediction, primary_body_);
+FlightPath::Segment FlightPath::BallisticSegment::segment() const {
+    Segment segment = CreateSegment(Segment::kBallistic);
+    segment.ballistic = packed_;
+    return segment;
 }
 
 FlightPath::CalculationStatus
@@ -478,110 +1083,165 @@ FlightPath::CalculationStatus
     if (t < calculation_status_.end_t) {
         return calculation_status_;
     }
-    // if no peer-bodies exist as children under parent
+    const BodyHierarchy &hierarchy = system_.hierarchy();
+    const BodyIndex primary_index = hierarchy.IndexOf(primary_body_);
+    const double primary_soi = hierarchy.sphere_of_influence(primary_index);
+    // if no peer-body can be reached,
     // and orbit never exceeds sphere of influence,
     // then segment will not have any end.
-    if (primary_body_.children().size() == 0 &&
-            orbit_.eccentricity() < 1.0 &&
-            orbit_.apoapsis() < primary_body_.sphere_of_influence()) {
+    if (peers_.empty() && !may_exit_) {
         CalculationStatus status;
-        Orbit orbit_at_end_t = orbit_.Predict(t + 1.0 - t0_);
+        const KinematicData end_data = ephemeris_.Predict(t + 1.0 - t0_) +
+            primary_body_.PredictSystemKinematicData(t + 1.0);
         status.end_t = t + 1.0;
-        status.r = orbit_at_end_t.position();
-        status.v = orbit_at_end_t.velocity();
+        status.r = end_data.r;
+        status.v = end_data.v;
         calculation_status_ = status;
         return calculation_status_;
     }
-    // Get max step duration. This value may be reduced later.
-    // If orbit is elliptical (e < 1) it should be some fraction of
-    // an orbital period. Otherwise, roughly proportional to the
-    // amount of time potentially required to escape the primary body's
-    // sphere of influence.
-    const double max_step_duration = orbit_.eccentricity() < 1.0 ?
-            orbit_.period() * kMaxOrbitPeriodDurationPerStep :
-            2 * PI / orbit_.mean_motion() * kMaxOrbitPeriodDurationPerStep;
-    // Create array of bodies in sphere of influence,
-    // and their max speed.
-    // These bodies, which share the same parent as the segment, are
-    // referred to here as peers.
-    std::vector<std::pair<Body*, double> > peer_body_speeds;
-    for (const BodyIdPair &body_id_pair : primary_body_.children()) {
-        // sanity check
-        if (body_id_pair.second->parent()->id() != primary_body_.id()) {
-            throw std::runtime_error("FlightPath::BallisticSegment::Calculate()"
-                " : Peer body's parent had different ID from BallisticSegment");
-        }
-        const std::pair<Body*, double> body_speed_pair(
-            body_id_pair.second.get(),
-            body_id_pair.second->orbit()->max_speed());
-        peer_body_speeds.push_back(body_speed_pair);
-    }
-    while (calculation_status_.end_t <= t) {
-        double step_t = calculation_status_.end_t;
+    // The segment ends when the orbit crosses the boundary of the
+    // primary's sphere of influence, or that of a body orbiting the
+    // same parent (referred to here as peers). Each boundary has an
+    // event function of time, which is positive while the boundary
+    // has not been crossed.
+    //
+    // Steps are bounded so that no event function can reach zero
+    // within a step: the event function's value divided by the
+    // fastest rate at which it can change. When an event function
+    // is found to be <= 0 at the end of a step, the crossing is
+    // refined within the step by root finding, and the segment ends
+    // there.
+    const auto exit_event = [this, primary_soi](const double event_t) {
+        return primary_soi - ephemeris_.PredictPosition(event_t - t0_).norm();
+    };
+    const auto peer_event = [this, &hierarchy](
+            const Body &peer, const double event_t) {
+        return (ephemeris_.PredictPosition(event_t - t0_) -
+                peer.PredictLocalPosition(event_t)).norm() -
+            hierarchy.sphere_of_influence(peer.index());
+    };
+
+    double step_t = std::max(calculation_status_.end_t, t0_);
+    while (step_t <= t) {
         // Find duration of step.
-        double step_duration = max_step_duration;
-        // Reduce step_duration if a peer sphere of influence may
-        // be intersected.
-        // Find smallest time-separation between predicted position and any
-        // spheres of influence of bodies orbiting the same parent
-        // (Referred to here as peers).
-        for (std::pair<Body*, double> body_speed_pair : peer_body_speeds) {
-            const Body * const body = body_speed_pair.first;
-            Vector local_position = orbit_.Predict(step_t - t0_).position();
-            Vector local_peer_position = body->PredictLocalPosition(step_t);
-            Vector position_difference = local_position - local_peer_position;
-            double distance = position_difference.norm() -
-                body->sphere_of_influence();
-            // Sanity check.
-            if (distance < 0) {
-                throw std::runtime_error(
-                    std::string("FlightPath::BallisticSegment::Calculate()") +
-                    " : Distance to peer-body " + std::string(body->id()) +
-                    " < 0.");
-            }
-            double time_separation = distance / body_speed_pair.second;
-            if (time_separation < step_duration) {
-                step_duration = time_separation;
-                // Enforce minimum step duration to avoid zeno's
-                // Achilles and the tortoise logic.
-                if (step_duration < kMinBallisticStepDuration) {
-                    step_duration = kMinBallisticStepDuration;
-                    break;  // There is no point in finding a closer peer body.
-                }
-            }
+        const KinematicData local_data = ephemeris_.Predict(step_t - t0_);
+        double step_duration = std::numeric_limits<double>::infinity();
+        if (may_exit_) {
+            // Distance to the SOI boundary decreases at no more than
+            // the orbital speed. While moving away from the primary,
+            // speed only decreases, so the current speed bounds it;
+            // while moving inwards, speed increases up to periapsis,
+            // so only the speed at periapsis does.
+            const double max_speed = local_data.r.dot(local_data.v) >= 0.0 ?
+                local_data.v.norm() : orbit_.max_speed();
+            step_duration = (primary_soi - local_data.r.norm()) / max_speed;
         }
-        if (!(step_duration > 0.0)) {
+        for (const std::pair<const Body*, double> &peer_speed_pair :
+                peers_) {
+            const Body &peer = *peer_speed_pair.first;
+            const double distance = (local_data.r -
+                peer.PredictLocalPosition(step_t)).norm() -
+                hierarchy.sphere_of_influence(peer.index());
+            step_duration = std::min(
+                step_duration, distance / peer_speed_pair.second);
+        }
+        // Enforce minimum step duration to avoid zeno's
+        // Achilles and the tortoise logic.
+        step_duration = std::max(step_duration, kMinBallisticStepDuration);
+        if (!(step_duration < std::numeric_limits<double>::infinity())) {
             throw std::runtime_error("FlightPath::BallisticSegment::Calculate()"
-                    " : step_duration was not > 0. value: " +
+                    " : step_duration was not finite. value: " +
                     std::to_string(step_duration));
         }
-        double new_t = step_t + step_duration;
-        calculation_status_.end_t = new_t;
-        // Advance calculation status
-        const Orbit orbit_prediction = orbit_.Predict(new_t - t0_);
-        const KinematicData local_data = orbit_prediction.kinematic_data();
-        const KinematicData parent_body_system_data =
-            primary_body_.PredictSystemKinematicData(new_t);
-        const KinematicData system_data = local_data + parent_body_system_data;
-        calculation_status_.r = system_data.r;
-        calculation_status_.v = system_data.v;
+        const double new_t = step_t + step_duration;
+
+        // Find the earliest crossing of any boundary within the step.
+        double crossing_t = new_t;
+        bool crossed = false;
+        if (may_exit_ && exit_event(new_t) <= 0.0) {
+            crossing_t = FindEventCrossing(exit_event, step_t, new_t);
+            crossed = true;
+        }
+        for (const std::pair<const Body*, double> &peer_speed_pair :
+                peers_) {
+            const Body &peer = *peer_speed_pair.first;
+            const auto event = [&peer_event, &peer](const double event_t) {
+                return peer_event(peer, event_t);
+            };
+            if (event(crossing_t) <= 0.0) {
+                crossing_t = FindEventCrossing(event, step_t, crossing_t);
+                crossed = true;
+            }
+        }
+        step_t = crossing_t;
         // If primary influence has changed,
         // this segment's end has been reached.
-        const Body &new_primary =
-            system_.FindPrimaryInfluence(system_data.r, new_t);
-        if (new_primary.id() != primary_body_.id()) {
-            break;
+        if (crossed) {
+            // Rounding may place the crossing marginally short of the
+            // boundary as seen by FindPrimaryInfluence(), so slightly
+            // later times within the step are also tried.
+            bool primary_changed = false;
+            for (double nudge = 0.0; crossing_t + nudge <= new_t;
+                    nudge = std::max(nudge * 2.0, kEventTimeTolerance)) {
+                const double end_t = crossing_t + nudge;
+                const Vector system_r =
+                    ephemeris_.PredictPosition(end_t - t0_) +
+                    primary_body_.PredictSystemPosition(end_t);
+                const Body &new_primary =
+                    system_.FindPrimaryInfluence(system_r, end_t);
+                if (new_primary.index() != primary_index) {
+                    step_t = end_t;
+                    primary_changed = true;
+                    break;
+                }
+            }
+            if (primary_changed) {
+                break;
+            }
         }
     }
+    // Advance calculation status
+    const KinematicData system_data = ephemeris_.Predict(step_t - t0_) +
+        primary_body_.PredictSystemKinematicData(step_t);
+    calculation_status_.end_t = step_t;
+    calculation_status_.r = system_data.r;
+    calculation_status_.v = system_data.v;
     return calculation_status_;
 }
 
+void FlightPath::BallisticSegment::FindReachablePeers() {
+    const BodyHierarchy &hierarchy = system_.hierarchy();
+    const BodyIndex primary_index = hierarchy.IndexOf(primary_body_);
+    const double inf = std::numeric_limits<double>::infinity();
+    const double min_r = orbit_.periapsis();
+    const double max_r = orbit_.eccentricity() < 1.0 ? orbit_.apoapsis() : inf;
+    const double max_speed = orbit_.max_speed();
+    const BodyIndex peers_end = hierarchy.children_end(primary_index);
+    for (BodyIndex i = hierarchy.first_child(primary_index);
+            i < peers_end; ++i) {
+        const Body &peer = hierarchy.body(i);
+        const Orbit &peer_orbit = *peer.orbit();
+        const double soi = hierarchy.sphere_of_influence(i);
+        const double peer_min_r = peer_orbit.periapsis() - soi;
+        const double peer_max_r = soi + (peer_orbit.eccentricity() < 1.0 ?
+            peer_orbit.apoapsis() : inf);
+        if (max_r < peer_min_r || peer_max_r < min_r) {
+            continue;
+        }
+        peers_.emplace_back(&peer, max_speed + peer_orbit.max_speed());
+    }
+}
+
 // SegmentGroup -------------------------------------------------------
 
 FlightPath::SegmentGroup::SegmentGroup(
         const System &system, const Maneuver * const maneuver,
-        const Vector r, const Vector v, const double t, const double tf):
-        system_(system), maneuver_(maneuver), r_(r), v_(v), t_(t), tf_(tf) {
+        const Segment::Kind kind,
+        const Vector r, const Vector v, const double t, const double tf,
+        Arena * const arena):
+        system_(system), maneuver_(maneuver), kind_(kind),
+        r_(r), v_(v), t_(t), tf_(tf),
+        segments_(ArenaAllocator<Segment>(arena)), data_(arena), step_(0.0) {
     if (t < 0) {
         throw std::invalid_argument("SegmentGroup::SegmentGroup() : "
             "Passed value t (" + std::to_string(t) + ") was < 0");
@@ -601,7 +1261,131 @@ FlightPath::SegmentGroup::SegmentGroup(
 }
 
 KinematicData FlightPath::SegmentGroup::Predict(const double t) const {
-    return GetSegment(t).Predict(t);
+    // Ballistic segments may be evaluated beyond their calculated end;
+    // other segments are only defined until it.
+    if (kind_ != Segment::kBallistic && t >= calculation_status_.end_t) {
+        throw std::invalid_argument("FlightPath::SegmentGroup::Predict() : "
+            "Passed t was >= end time of calculation. t: " +
+            std::to_string(t) + " end: " +
+            std::to_string(calculation_status_.end_t));
+    }
+    return Predict(GetSegment(t), t);
+}
+
+KinematicData FlightPath::SegmentGroup::Predict(
+        const Segment &segment, const double t) const {
+    if (segment.kind == Segment::kConstantAcceleration) {
+        // A number of approximations are made here that reduce the
+        // accuracy of the result, but which simplify the code,
+        // and are faster to evaluate.
+        // If accuracy becomes an issue, this method should be re-written.
+        const Segment::Acceleration &acceleration = segment.acceleration;
+        const Vector r0(acceleration.r0);
+        const Vector v0(acceleration.v0);
+        const Vector a(acceleration.a);
+        const double rel_t = t - segment.t0;
+        return {r0 + v0 * rel_t + a * (std::pow(rel_t, 2) / 2),
+                v0 + a * rel_t};
+    }
+    const Body &primary = system_.hierarchy().body(segment.primary);
+    return PredictLocal(segment, t) + primary.PredictSystemKinematicData(t);
+}
+
+void FlightPath::SegmentGroup::Predict(
+        const Segment &segment, const double * const times,
+        const std::size_t n, Vector * const r, Vector * const v) const {
+    if (segment.kind != Segment::kBallistic) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const KinematicData kinematics = Predict(segment, times[i]);
+            r[i] = kinematics.r;
+            v[i] = kinematics.v;
+        }
+        return;
+    }
+    // The ephemeris is unpacked once, and each Kepler solve begins
+    // from the solution of the time before it.
+    const OrbitEphemeris ephemeris(segment.ballistic);
+    EphemerisCursor cursor(ephemeris);
+    const Body &primary = system_.hierarchy().body(segment.primary);
+    for (std::size_t i = 0; i < n; ++i) {
+        const KinematicData local = cursor.Predict(times[i] - segment.t0);
+        const KinematicData body = primary.PredictSystemKinematicData(times[i]);
+        r[i] = local.r + body.r;
+        v[i] = local.v + body.v;
+    }
+}
+
+void FlightPath::SegmentGroup::Tessellate(
+        const Segment &segment, const double t0, const double t1,
+        const double tolerance, std::vector<Vector> * const vertices,
+        std::vector<double> * const times) const {
+    if (segment.kind != Segment::kBallistic ||
+            segment.ballistic.e == 1.0) {
+        // Segments other than conics are followed in time, from
+        // a few initial parts so that their midpoints are meaningful.
+        const auto evaluate = [this, &segment](const double t) {
+            return PolylineVertex{t, t, Predict(segment, t).r};
+        };
+        PolylineVertex first = evaluate(t0);
+        for (int i = 1; i <= kMinManeuverTessellationParts; ++i) {
+            const PolylineVertex last = evaluate(
+                t0 + (t1 - t0) * i / kMinManeuverTessellationParts);
+            Subdivide(first, last, tolerance, evaluate, vertices, times);
+            first = last;
+        }
+        return;
+    }
+    // Conics are followed in true anomaly, which advances fastest
+    // where the path turns quickly, without solving Kepler's equation
+    // for any vertex between the ends.
+    const OrbitEphemeris ephemeris(segment.ballistic);
+    const Body &primary = system_.hierarchy().body(segment.primary);
+    const double e = ephemeris.eccentricity();
+    const auto evaluate_anomaly = [&](const double anomaly, const double t) {
+        return PolylineVertex{FindTrueAnomaly(e, anomaly), t,
+            ephemeris.EvaluatePosition(anomaly) +
+            primary.PredictSystemPosition(t)};
+    };
+    const auto evaluate_time = [&](const double t) {
+        return evaluate_anomaly(SolveKepler(
+            e, ephemeris.FindMeanAnomaly(t - segment.t0)), t);
+    };
+    const auto evaluate = [&](const double true_anomaly) {
+        const double anomaly = FindEccentricAnomaly(e, true_anomaly);
+        const double mean_anomaly = e < 1.0 ?
+            anomaly - e * std::sin(anomaly) :
+            e * std::sinh(anomaly) - anomaly;
+        PolylineVertex vertex = evaluate_anomaly(anomaly, segment.t0 +
+            (mean_anomaly - ephemeris.epoch_mean_anomaly()) /
+            ephemeris.mean_motion());
+        vertex.p = true_anomaly;
+        return vertex;
+    };
+    // Parts are limited in the angle they turn through, so that the
+    // curve cannot double back on a line with its midpoint near it.
+    PolylineVertex first = evaluate_time(t0);
+    const PolylineVertex end = evaluate_time(t1);
+    const int n_parts = std::max(1, static_cast<int>(
+        std::ceil((end.p - first.p) / kMaxTessellationAnomaly)));
+    for (int i = 1; i <= n_parts; ++i) {
+        const PolylineVertex last = i == n_parts ?
+            end : evaluate(first.p + (end.p - first.p) * i / n_parts);
+        Subdivide(first, last, tolerance, evaluate, vertices, times);
+        first = last;
+    }
+}
+
+OrbitData FlightPath::SegmentGroup::PredictOrbit(const double t) const {
+    Predict(t);  // Validates t.
+    return PredictOrbit(GetSegment(t), t);
+}
+
+OrbitData FlightPath::SegmentGroup::PredictOrbit(
+        const Segment &segment, const double t) const {
+    const KinematicData local = PredictLocal(segment, t);
+    // Orbital elements are only found if requested.
+    return OrbitData(
+        system_.hierarchy().body(segment.primary), local.r, local.v);
 }
 
 const FlightPath::Segment&
@@ -610,15 +1394,14 @@ const FlightPath::Segment&
         throw std::runtime_error("SegmentGroup::GetSegment() : "
             "No segments present.");
     }
-    const auto following_iterator = segments_.upper_bound(t);
-    if (following_iterator == segments_.begin()) {
+    const std::size_t following_index = segments_.UpperBound(t);
+    if (following_index == 0) {
         throw std::invalid_argument(
             "FlightPath::SegmentGroup::GetSegment() : "
             "Passed time precedes first segment in SegmentGroup: " +
             std::to_string(t));
     }
-    const auto iterator = std::prev(following_iterator);
-    return *iterator->second;
+    return segments_[following_index - 1];
 }
 
 FlightPath::CalculationStatus
@@ -642,8 +1425,7 @@ FlightPath::CalculationStatus
     // If the last segment has not finished being calculated,
     // continue calculating it until time t is reached or segment ends.
     if (calculation_status_.incomplete_element) {
-        Segment &last_segment = *segments_.rbegin()->second;
-        calculation_status_ = last_segment.Calculate(t);
+        calculation_status_ = ContinueSegment(t);
     }
     // Progress calculation of flight path until time t is reached or
     // SegmentGroup ends.
@@ -652,14 +1434,12 @@ FlightPath::CalculationStatus
         const Vector r = calculation_status_.r;
         const Vector v = calculation_status_.v;
         const double segment_time = calculation_status_.end_t;
-        std::unique_ptr<Segment> segment = CreateSegment(r, v, segment_time);
-        calculation_status_ = segment->Calculate(t);
+        calculation_status_ = BeginSegment(r, v, segment_time, t);
         // Check to prevent infinite loops. An error is preferable.
         if (calculation_status_.end_t <= segment_time) {
             throw std::runtime_error("SegmentGroup::Calculate() : "
                 "Calculation of segment did not result in later end-time");
         }
-        segments_[segment_time] = std::move(segment);
     }
     // Trim calculation status if calculation overran group end time.
     if (tf_ != -1.0 && calculation_status_.end_t > tf_) {
@@ -675,46 +1455,162 @@ FlightPath::CalculationStatus
     return calculation_status_;
 }
 
+bool FlightPath::SegmentGroup::Truncate(const double t) {
+    if (t <= t_) {
+        return false;
+    }
+    if (tf_ != -1.0 && tf_ <= t) {
+        return true;  // Group already ends before t.
+    }
+    if (maneuver_ != nullptr) {
+        return false;
+    }
+    // Ballistic segments are valid until any time at which they are
+    // ended, so those beginning before t are kept as they are.
+    if (t < calculation_status_.end_t) {
+        const KinematicData kinematics = Predict(t);
+        std::size_t n_kept = segments_.UpperBound(t);
+        if (segments_.t(n_kept - 1) == t) {
+            --n_kept;
+        }
+        segments_.Truncate(n_kept);
+        ballistic_.reset();
+        calculation_status_ = CalculationStatus(kinematics.r, kinematics.v, t);
+    }
+    // Otherwise, the last segment continues to be calculated until t.
+    tf_ = t;
+    return true;
+}
+
+FlightPath::CalculationStatus FlightPath::SegmentGroup::BeginSegment(
+        const Vector r, const Vector v, const double t0, const double t) {
+    CalculationStatus status;
+    switch (kind_) {
+        case Segment::kBallistic:
+            ballistic_ = std::make_unique<BallisticSegment>(system_, r, v, t0);
+            status = ballistic_->Calculate(t);
+            segments_.Append(t0, ballistic_->segment());
+            break;
+        case Segment::kConstantAcceleration:
+        case Segment::kIntegrated: {
+            // Integrated segments continue with the step size
+            // suggested by the preceding segment.
+            const ManeuverSegment segment(
+                system_, *maneuver_, r, v, t0, step_, &data_);
+            status = segment.Calculate(t);
+            step_ = segment.next_step();
+            segments_.Append(t0, segment.segment());
+            break;
+        }
+        case Segment::kEncke:
+            encke_ = std::make_unique<EnckeSegment>(
+                system_, *maneuver_, r, v, t0, step_, &data_);
+            status = encke_->Calculate(t);
+            step_ = encke_->next_step();
+            segments_.Append(t0, encke_->segment());
+            break;
+    }
+    return status;
+}
+
+FlightPath::CalculationStatus
+        FlightPath::SegmentGroup::ContinueSegment(const double t) {
+    CalculationStatus status = calculation_status_;
+    switch (kind_) {
+        case Segment::kBallistic:
+            status = ballistic_->Calculate(t);
+            break;
+        case Segment::kEncke:
+            status = encke_->Calculate(t);
+            step_ = encke_->next_step();
+            segments_.back() = encke_->segment();
+            break;
+        case Segment::kConstantAcceleration:
+        case Segment::kIntegrated:
+            // These segments are calculated in full when begun.
+            status.incomplete_element = false;
+            break;
+    }
+    return status;
+}
+
+KinematicData FlightPath::SegmentGroup::PredictLocal(
+        const Segment &segment, const double t) const {
+    switch (segment.kind) {
+        case Segment::kBallistic:
+            return OrbitEphemeris(segment.ballistic).Predict(t - segment.t0);
+        case Segment::kConstantAcceleration: {
+            const KinematicData system_data = Predict(segment, t);
+            const KinematicData body_data = system_.hierarchy().body(
+                segment.primary).PredictSystemKinematicData(t);
+            return {system_data.r - body_data.r, system_data.v - body_data.v};
+        }
+        case Segment::kIntegrated:
+            return ToKinematicData(
+                data_.steps[segment.steps.first].Interpolate(t));
+        case Segment::kEncke: {
+            const DenseStep &step = FindStep(data_.steps, segment.steps.first,
+                segment.steps.first + segment.steps.n, t);
+            return data_.references[segment.steps.reference].Predict(
+                t - segment.t0) + ToKinematicData(step.Interpolate(t));
+        }
+    }
+    throw std::logic_error("SegmentGroup::PredictLocal() : "
+        "Unknown segment kind");
+}
+
 // ManeuverSegmentGroup -----------------------------------------------
 
 FlightPath::ManeuverSegmentGroup::ManeuverSegmentGroup(
         const System &system,
         const Maneuver * const maneuver,
-        const Vector r, const Vector v, const double t):
-            SegmentGroup(system, maneuver, r, v, t, maneuver->t1()) {
+        const Vector r, const Vector v, const double t, Arena * const arena):
+            ManeuverSegmentGroup(
+                system, CheckManeuver(maneuver), r, v, t, arena) {}
+
+FlightPath::ManeuverSegmentGroup::ManeuverSegmentGroup(
+        const System &system,
+        const Maneuver &maneuver,
+        const Vector r, const Vector v, const double t, Arena * const arena):
+            SegmentGroup(system, &maneuver, [&maneuver]() {
+                // Impulsive maneuvers are only given a group of
+                // their own when one is created directly, and are
+                // then approximated as any other.
+                switch (maneuver.propagation()) {
+                    case Maneuver::kIntegrated:
+                        return Segment::kIntegrated;
+                    case Maneuver::kEncke:
+                        return Segment::kEncke;
+                    default:
+                        return Segment::kConstantAcceleration;
+                }
+            }(), r, v, t, maneuver.t1(), arena) {
     // validate input
-    if (maneuver == nullptr) {
-        throw std::invalid_argument(
-            "ManeuverSegmentGroup::ManeuverSegmentGroup() : "
-            "Passed maneuver was null");
-    }
-    if (maneuver->t0() != t) {
+    if (maneuver.t0() != t) {
         throw std::invalid_argument(
             "ManeuverSegmentGroup::ManeuverSegmentGroup() : "
             "t: " + std::to_string(t) + " does not match maneuver t0: " +
-            std::to_string(maneuver->t0()));
+            std::to_string(maneuver.t0()));
     }
 }
 
-std::unique_ptr<FlightPath::Segment>
-        FlightPath::ManeuverSegmentGroup::CreateSegment(
-        const Vector r, const Vector v, const double t) const {
-    return std::move(std::make_unique<ManeuverSegment>(
-        system_, *maneuver_, r, v, t));
+const Maneuver& FlightPath::ManeuverSegmentGroup::CheckManeuver(
+        const Maneuver * const maneuver) {
+    if (maneuver == nullptr) {
+        throw std::invalid_argument(
+            "ManeuverSegmentGroup::ManeuverSegmentGroup() : "
+            "Passed maneuver was null");
+    }
+    return *maneuver;
 }
 
 // BallisticSegmentGroup ----------------------------------------------
 
 FlightPath::BallisticSegmentGroup::BallisticSegmentGroup(
         const System &system,
-        const Vector r, const Vector v, const double t, const double tf):
-            SegmentGroup(system, nullptr, r, v, t, tf) {}
-
-std::unique_ptr<FlightPath::Segment>
-        FlightPath::BallisticSegmentGroup::CreateSegment(
-        const Vector r, const Vector v, const double t) const {
-    return std::move(std::make_unique<BallisticSegment>(system_, r, v, t));
-}
-
+        const Vector r, const Vector v, const double t, const double tf,
+        const Maneuver * const maneuver, Arena * const arena):
+            SegmentGroup(system, maneuver, Segment::kBallistic,
+                         r, v, t, tf, arena) {}
 
 }  // namespace kin
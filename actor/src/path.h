@@ -17,10 +17,18 @@
 #ifndef ACTOR_SRC_PATH_H_
 #define ACTOR_SRC_PATH_H_
 
-#include <map>
+#include <cstdint>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "vector.h"
+#include "arena.h"
+#include "body.h"
+#include "ephemeris.h"
+#include "integrator.h"
 #include "orbit.h"
+#include "timeline.h"
+#include "universal.h"
 #include "util.h"
 
 namespace kin {
@@ -31,21 +39,34 @@ class System;
 
 /**
  * Structure containing information about an orbit.
+ *
+ * OrbitData holds the position and velocity of an object relative to
+ * a body; orbital elements are calculated from them only when orbit()
+ * is first called. orbit() may be called from multiple threads.
  */
 class OrbitData {
  public:
-    OrbitData(const Orbit orbit, const Body &body):
-        orbit_(orbit), body_(body) {}
+    OrbitData(const Orbit orbit, const Body &body);
+    OrbitData(const Body &body, const Vector r, const Vector v):
+        body_(body), r_(r), v_(v) {}
 
-    const Orbit &orbit() const { return orbit_; }
+    const Orbit &orbit() const;
     const Body &body() const { return body_; }
+    const Vector &position() const { return r_; }  // relative to body
+    const Vector &velocity() const { return v_; }  // relative to body
 
     // Getters such as altitude, system_r, system_v, etc can be
     // added later.
 
  private:
-    const Orbit orbit_;
+    OrbitData(const Body &body, const KinematicData &data, const Orbit &orbit);
+
     const Body &body_;
+    const Vector r_;
+    const Vector v_;
+    // Found on first call to orbit(), and only accessed atomically.
+    // Copies made afterwards share the found elements.
+    mutable std::shared_ptr<const Orbit> orbit_;
 };
 
 /**
@@ -79,6 +100,28 @@ class Maneuver {
         kFixed
     };
 
+    /**
+     * Enum defining how the trajectory over the course of the
+     * maneuver is found.
+     *
+     * kConstantAcceleration approximates the maneuver as a series of
+     * short segments, each with a constant acceleration.
+     * kIntegrated numerically integrates the equations of motion with
+     * error control, so that each segment is as long as the requested
+     * accuracy allows.
+     * kEncke integrates only the deviation from a reference conic
+     * (Encke's method), so gentle burns allow far longer steps, and
+     * each segment lasts until the deviation grows large enough that
+     * the reference conic must be replaced (rectified).
+     * kImpulsive applies the maneuver's entire delta-V instantly at
+     * the midpoint of its burn, so that the path is ballistic
+     * throughout; this is accurate only for burns much shorter than
+     * the orbital period.
+     */
+    enum Propagation {
+        kConstantAcceleration, kIntegrated, kEncke, kImpulsive
+    };
+
     Maneuver(ManeuverType type,
              double dv,
              const PerformanceData performance,
@@ -101,7 +144,12 @@ class Maneuver {
     double m1() const { return m0_ - expended_mass(); }
     double t0() const { return t0_; }
     double t1() const { return t0_ + duration(); }  // end time of maneuver.
+    double mid_t() const { return t0_ + duration() / 2; }  // burn midpoint.
     const PerformanceData& performance() const { return performance_; }
+    Propagation propagation() const { return propagation_; }
+    void set_propagation(Propagation propagation) {
+        propagation_ = propagation;
+    }
     double duration() const;
     double mass_fraction() const;  // mass ratio 0-1 which is expended.
     double expended_mass() const;  // propellant mass expended.
@@ -119,6 +167,12 @@ class Maneuver {
     Vector FindThrustVector(
         const Body &ref, const Vector r, const Vector v, const double t) const;
 
+    /**
+     * Finds normalized thrust direction from position and velocity
+     * that are already relative to the reference body.
+     */
+    Vector FindThrustVector(const Vector rel_r, const Vector rel_v) const;
+
  private:
     ManeuverType type_;  // type of maneuver
     Vector fixed_vector_;  // Used when vector is fixed, otherwise ignored.
@@ -126,6 +180,7 @@ class Maneuver {
     PerformanceData performance_;
     double m0_;
     double t0_;
+    Propagation propagation_;
 };
 
 
@@ -144,6 +199,40 @@ class FlightPath {
     /** Gets KinematicData for passed point in time since t0 */
     KinematicData Predict(const double time) const;
 
+    /**
+     * Predicts path at each of n passed times, writing position and
+     * velocity at times[i] to r[i] and v[i]; r and v must each have
+     * room for n vectors.
+     *
+     * Consecutive times within the same segment are evaluated
+     * together, so that the segment is prepared once for all of
+     * them; times are best passed in increasing order.
+     */
+    void PredictAt(const double *times, const std::size_t n,
+                   Vector *r, Vector *v) const;
+
+    /**
+     * Finds a polyline following the path from t0 to t1, no line of
+     * which is further than tolerance from the path between its ends,
+     * as measured at the middle of the line's span. Vertices, in the
+     * system frame, and optionally their times, replace the contents
+     * of the passed vectors.
+     *
+     * Ballistic segments are divided in true anomaly, so that vertices
+     * are closest together where the path turns fastest; other
+     * segments are divided in time.
+     */
+    void Tessellate(const double t0, const double t1, const double tolerance,
+                    std::vector<Vector> *vertices,
+                    std::vector<double> *times = nullptr) const;
+
+    /**
+     * Predicts path at n times evenly spaced from t0 to t1
+     * inclusive. Passed vectors are resized to n.
+     */
+    void PredictRange(const double t0, const double t1, const std::size_t n,
+                      std::vector<Vector> *r, std::vector<Vector> *v) const;
+
     /**
      * Gets OrbitData for passed point in time since t0.
      *
@@ -204,11 +293,72 @@ class FlightPath {
      */
     bool Remove(const Maneuver &maneuver);
 
+    /**
+     * Finds the error introduced by approximating passed maneuver as
+     * impulsive, as the difference between the position and velocity
+     * of the path at the end of the maneuver, and those found by
+     * integrating the finite burn from the start of the maneuver.
+     *
+     * Passed maneuver must be one of the path's maneuvers that is
+     * treated as impulsive.
+     */
+    KinematicData FindImpulseError(const Maneuver &maneuver) const;
+
+    /**
+     * Ratio of burn duration to orbital period at or below which
+     * maneuvers are treated as impulsive, regardless of their
+     * propagation. Zero by default, so that only maneuvers with
+     * kImpulsive propagation are.
+     */
+    double impulse_ratio() const { return impulse_ratio_; }
+    void set_impulse_ratio(const double ratio);
+
+    /**
+     * Gets arena from which calculated path data is allocated, for
+     * its allocation statistics.
+     */
+    const Arena& cache_arena() const { return cache_.arena; }
+
+    /**
+     * Predicts a FlightPath at a series of times, remembering the
+     * group and segment in effect at the last time, so that times
+     * advancing through the path are found without searching for
+     * them. Earlier times, or times far ahead, are searched for as
+     * by FlightPath::Predict().
+     *
+     * The path must outlive the Cursor, which remains valid when
+     * the path's maneuvers are changed.
+     */
+    class Cursor {
+     public:
+        explicit Cursor(const FlightPath &path);
+
+        KinematicData Predict(const double t);
+        OrbitData PredictOrbit(const double t);
+
+        /** As FlightPath::PredictAt(), continuing from the cursor. */
+        void PredictAt(const double *times, const std::size_t n,
+                       Vector *r, Vector *v);
+
+     private:
+        const FlightPath &path_;
+        // Upper bounds of the last time in the path's groups, and in
+        // the segments of the group in effect.
+        std::size_t group_bound_;
+        std::size_t segment_bound_;
+
+        /** Moves cursor to group and segment in effect at time t. */
+        void Seek(const double t);
+    };
+
  private:
     // forward declared nested classes  (declared in full below)
 
-    class Segment;
+    struct Segment;
+    struct SegmentData;
+    class SegmentCalculator;
     class ManeuverSegment;
+    class EnckeSegment;
     class BallisticSegment;
     class SegmentGroup;
     class ManeuverSegmentGroup;
@@ -239,14 +389,21 @@ class FlightPath {
         // which in turn contains SegmentGroups associated with each
         // burn or coast period
         // which in turn contain path segments.
-        std::map<double, std::unique_ptr<SegmentGroup> > groups;
+        // SegmentGroups, and the storage of their segments, are
+        // allocated from the arena, so that all may be released at
+        // once when the cache is cleared.
+        Arena arena;
+        Timeline<SegmentGroup*> groups;
         // stores result of last path calculation
         CalculationStatus status;
+        // Number of groups discarded from the arena since it was
+        // last reset, which remain allocated until then.
+        std::size_t n_discarded_groups = 0;
     };
 
     // members
 
-    std::map<double, std::unique_ptr<Maneuver> > maneuvers_;
+    Timeline<std::unique_ptr<Maneuver> > maneuvers_;
     // Raw pointer should never be invalid when used as intended;
     // system owns actor, which owns path. If system is destroyed,
     // so is FlightPath.
@@ -254,6 +411,7 @@ class FlightPath {
     const Vector r0_;  // position relative to system origin
     const Vector v0_;  // velocity relative to system
     const double t0_;  // start time of flight path relative to system
+    double impulse_ratio_;
     mutable FlightPathCache cache_;
 
     /**
@@ -264,10 +422,18 @@ class FlightPath {
     void Calculate(const double t) const;
 
     /**
-     * Get Segment of orbit which describes position at time t.
+     * Get SegmentGroup which describes position at time t.
      * This method may have to calculate
      * additional orbital segments before it can return the
-     * desired Segment.
+     * desired SegmentGroup.
+     */
+    const SegmentGroup& GetGroup(const double t) const;
+
+    /**
+     * Get Segment of orbit which describes position at time t.
+     * As with GetGroup(), segments may be calculated first; as that
+     * may add segments to the group, the returned reference is only
+     * valid until the path is next calculated further.
      */
     const Segment& GetSegment(const double t) const;
 
@@ -278,6 +444,21 @@ class FlightPath {
      */
     void ClearCache() const;  // Only mutable members changed.
 
+    /**
+     * Clears cached data from time t onwards, keeping the path
+     * calculated before it, from which calculation will resume.
+     * This is intended to be used when maneuvers at or after t are
+     * changed, and must be called while they are still in the path.
+     */
+    void ClearCacheAfter(const double t) const;
+
+    /**
+     * Checks whether passed maneuver is to be treated as impulsive,
+     * given the system-relative position and velocity at its start.
+     */
+    bool IsImpulsive(const Maneuver &maneuver,
+                     const Vector r, const Vector v) const;
+
     // private getters
 
     /** Gets last group in cache */
@@ -294,35 +475,82 @@ class FlightPath {
      * Each segment has only a single primary influence, and so a
      * Segment must end when it moves into a different primary sphere
      * of influence.
+     *
+     * Segments are compact records of plain data, held by value in
+     * the SegmentGroup they belong to, which evaluates them according
+     * to their kind. Data too large to be held in the record itself
+     * (integrator steps, and reference conics) is held by the group
+     * in a SegmentData, and referred to by index.
+     *
+     * Segments are produced by the SegmentCalculator classes below.
      */
-    class Segment {
+    struct Segment {
+        enum Kind: std::uint8_t {
+            kBallistic, kConstantAcceleration, kIntegrated, kEncke
+        };
+
+        /** Constant acceleration approximation, relative to system. */
+        struct Acceleration {
+            double r0[3];
+            double v0[3];
+            double a[3];
+        };
+
+        /** Range of steps in the group's SegmentData. */
+        struct Steps {
+            std::uint32_t first;
+            std::uint32_t n;
+            std::uint32_t reference;  // Index of reference conic (kEncke).
+        };
+
+        double t0;          // Start time, relative to universe t0.
+        BodyIndex primary;  // Index of primary body in system hierarchy.
+        Kind kind;
+        union {
+            PackedEphemeris ballistic;  // Relative to primary body.
+            Acceleration acceleration;  // kConstantAcceleration
+            Steps steps;                // kIntegrated, kEncke
+        };
+    };
+
+    static_assert(sizeof(Segment) <= 96, "Segment records should be compact");
+
+    /**
+     * Data of a SegmentGroup's Segments which is too large to be held
+     * in the Segments themselves.
+     */
+    struct SegmentData {
+        explicit SegmentData(Arena *arena = nullptr):
+            steps(ArenaAllocator<DenseStep>(arena)),
+            references(ArenaAllocator<UniversalPropagator>(arena)) {}
+
+        // Integrator steps, relative to the primary body; the
+        // deviation from a reference conic for Encke segments.
+        std::vector<DenseStep, ArenaAllocator<DenseStep> > steps;
+        // Osculating conics from which Encke segments deviate,
+        // relative to the primary body.
+        std::vector<UniversalPropagator,
+                    ArenaAllocator<UniversalPropagator> > references;
+    };
+
+    // ----------------------------------------------------------------
+
+    /**
+     * Base of classes which calculate a Segment: finding when it
+     * ends, and producing the record that describes it.
+     */
+    class SegmentCalculator {
      public:
         /**
-         * Creates segment, that begins at position r, with velocity v,
-         * at time t.
+         * Creates calculator for a segment that begins at position r,
+         * with velocity v, at time t.
          *
          * r is relative to the system origin
          * v is relative to the system motion
          * t is relative to universe t0.
          */
-        Segment(const System &system, const Vector r, const Vector v, double t);
-
-        virtual ~Segment() {}
-
-        /**
-         * Predicts orbital trajectory at passed time.
-         * time is relative to universe t0.
-         *
-         * Returned KinematicData is relative to system.
-         */
-        virtual KinematicData Predict(const double t) const = 0;
-
-        virtual OrbitData PredictOrbit(const double t) const = 0;
-
-        /**
-         * Calculates flight path until passed time t or Segment ends.
-         */
-        virtual CalculationStatus Calculate(const double t) const = 0;
+        SegmentCalculator(
+            const System &system, const Vector r, const Vector v, double t);
 
      protected:
         const System &system_;
@@ -337,32 +565,112 @@ class FlightPath {
          * of segment.
          */
         void CheckPredictionTime(const double t) const;
+
+        /** Creates Segment of passed kind, with common fields set. */
+        Segment CreateSegment(const Segment::Kind kind) const;
     };
 
     // ----------------------------------------------------------------
 
-    class ManeuverSegment: public Segment {
+    class ManeuverSegment: public SegmentCalculator {
      public:
+        /**
+         * Integrated segments store their step in passed data, which
+         * must outlive the ManeuverSegment.
+         */
         ManeuverSegment(
             const System &system,
             const Maneuver &maneuver,
             const Vector r,
             const Vector v,
-            double t);
+            double t,
+            double step,
+            SegmentData *data);
 
-        KinematicData Predict(const double t) const;
-        OrbitData PredictOrbit(const double t) const;
         CalculationStatus Calculate(const double t) const;
 
+        /** Gets Segment record; valid once calculated. */
+        Segment segment() const;
+
+        /**
+         * Integration step size suggested for the segment following
+         * this one. Only meaningful for integrated maneuvers.
+         */
+        double next_step() const { return step_; }
+
      private:
         const Maneuver &maneuver_;
         const double m0_;               // Mass at beginning of segment.
+        SegmentData * const data_;
+        const std::uint32_t first_step_;  // Index of step in data_.
         mutable Vector a_;              // Acceleration used for approximation.
+        // Integrated maneuvers only.
+        mutable double step_;           // Step attempted, then suggested.
+
+        /**
+         * Calculates segment as a single step of a DormandPrince
+         * integrator, ending no later than the end of the maneuver.
+         */
+        CalculationStatus Integrate() const;
+    };
+
+    // ----------------------------------------------------------------
+
+    /**
+     * Maneuver segment propagated by Encke's method: the trajectory
+     * is the sum of the osculating conic at the start of the segment
+     * and an integrated deviation from it, caused by thrust and by
+     * the difference in gravity between the two positions.
+     *
+     * The segment ends (and a new reference conic is found by the
+     * next segment) once the deviation exceeds a fraction of the
+     * distance from the primary, or when the maneuver ends.
+     *
+     * Steps and the reference conic are stored in passed data, which
+     * must outlive the EnckeSegment, and to which no other segment
+     * may add steps while this one is being calculated.
+     */
+    class EnckeSegment: public SegmentCalculator {
+     public:
+        EnckeSegment(
+            const System &system,
+            const Maneuver &maneuver,
+            const Vector r,
+            const Vector v,
+            double t,
+            double step,
+            SegmentData *data);
+
+        CalculationStatus Calculate(const double t) const;
+
+        /** Gets Segment record, including steps calculated so far. */
+        Segment segment() const;
+
+        /** Integration step size suggested for the following segment. */
+        double next_step() const { return step_; }
+
+     private:
+        const Maneuver &maneuver_;
+        // Osculating conic at t0, relative to primary body.
+        const UniversalPropagator reference_;
+        const DormandPrince integrator_;
+        SegmentData * const data_;
+        const std::uint32_t first_step_;  // Index of first step in data_.
+        const std::uint32_t reference_index_;  // Index of reference_ copy.
+        mutable double step_;           // Step attempted, then suggested.
+        mutable bool calculation_complete_;
+
+        /** Predicts position and velocity relative to primary body. */
+        KinematicData PredictLocal(const double t) const;
+
+        /** Returns derivative of deviation from reference_. */
+        StateVector FindDeviationDerivative(
+            const double t, const StateVector &deviation) const;
     };
 
     // ----------------------------------------------------------------
 
-    class BallisticSegment: public Segment {
+    class BallisticSegment: public SegmentCalculator {
      public:
         BallisticSegment(
             const System &system,
@@ -371,12 +679,30 @@ class FlightPath {
             double t);
 
         KinematicData Predict(const double t) const;
-        OrbitData PredictOrbit(const double t) const;
         CalculationStatus Calculate(const double t) const;
 
+        /** Gets Segment record. */
+        Segment segment() const;
+
      private:
         Orbit orbit_;
-        bool calculation_complete_;
+        PackedEphemeris packed_;  // Form of orbit_ stored in Segment.
+        // Unpacked from packed_, rather than compiled from orbit_, so
+        // that calculation and later prediction agree exactly.
+        OrbitEphemeris ephemeris_;
+        bool may_exit_;  // Whether orbit_ may leave primary's SOI.
+        // Bodies orbiting the primary whose SOI orbit_ may enter,
+        // each with the greatest rate at which distance to it can
+        // decrease.
+        std::vector<std::pair<const Body*, double> > peers_;
+
+        /**
+         * Finds peers whose sphere of influence orbit_ may enter.
+         * Peers whose SOI sweeps out a radial shell around the
+         * primary that does not overlap the range of distances
+         * covered by orbit_ can never be reached, and are excluded.
+         */
+        void FindReachablePeers();
     };
 
     // ----------------------------------------------------------------
@@ -384,17 +710,51 @@ class FlightPath {
     /**
      * Grouping of Segments grouped by the maneuver that they take
      * place during.
+     *
+     * All segments of a group are of the same kind, so the group
+     * dispatches on its kind once per segment calculated or
+     * evaluated, rather than through virtual methods of each segment.
      */
     class SegmentGroup {
      public:
+        /**
+         * If an arena is passed, segments are stored in memory from
+         * it, and it must outlive the group.
+         */
         SegmentGroup(const System &system, const Maneuver * const maneuver,
-            const Vector r, const Vector v, double t, double tf = -1.0);
+            const Segment::Kind kind,
+            const Vector r, const Vector v, double t, double tf = -1.0,
+            Arena *arena = nullptr);
 
         virtual ~SegmentGroup() {}
 
         /** Gets Orbit object for passed time relative to universe t0. */
         KinematicData Predict(const double t) const;
 
+        /** Predicts passed Segment of this group at time t. */
+        KinematicData Predict(const Segment &segment, const double t) const;
+
+        /**
+         * Predicts passed Segment of this group at each of n times,
+         * writing results to r and v.
+         */
+        void Predict(const Segment &segment, const double *times,
+                     const std::size_t n, Vector *r, Vector *v) const;
+
+        OrbitData PredictOrbit(const double t) const;
+
+        /**
+         * Appends polyline following passed Segment of this group
+         * from time t0, exclusive, to t1, as FlightPath::Tessellate().
+         */
+        void Tessellate(const Segment &segment, const double t0,
+                        const double t1, const double tolerance,
+                        std::vector<Vector> *vertices,
+                        std::vector<double> *times) const;
+
+        /** Finds OrbitData of passed Segment of this group at time t. */
+        OrbitData PredictOrbit(const Segment &segment, const double t) const;
+
         /** Gets segment that includes passed time t. */
         const Segment& GetSegment(const double t) const;
 
@@ -404,28 +764,52 @@ class FlightPath {
          */
         CalculationStatus Calculate(const double t);
 
+        /**
+         * Ends group at time t, discarding any segments beginning at
+         * or after it, so that calculation of the path may resume
+         * from t. Returns false if the group cannot be kept, because
+         * it begins at t, or is of a maneuver which continues past t.
+         */
+        bool Truncate(const double t);
+
         // getters
-        const std::map<double, std::unique_ptr<Segment> >& segments() const {
+        const Timeline<Segment, ArenaAllocator<Segment> >& segments() const {
             return segments_;
         }
         const Maneuver* maneuver() const { return maneuver_; }
+        const CalculationStatus& calculation_status() const {
+            return calculation_status_;
+        }
 
      protected:
         const System &system_;
         const Maneuver * const maneuver_;
+        const Segment::Kind kind_;
         const Vector r_;
         const Vector v_;
         const double t_;
-        const double tf_;
-        std::map<double, std::unique_ptr<Segment> > segments_;
+        double tf_;  // End of group, or -1 if unbounded.
+        Timeline<Segment, ArenaAllocator<Segment> > segments_;
+        SegmentData data_;
         CalculationStatus calculation_status_;
+        // Calculators of last segment, kept while it may be incomplete.
+        std::unique_ptr<BallisticSegment> ballistic_;
+        std::unique_ptr<EnckeSegment> encke_;
+        double step_;  // Integrator step size suggested by last segment.
 
         /**
-         * Constructs new segment to be added to group.
+         * Begins new segment at position r and velocity v at time t0,
+         * and calculates it until time t or its end.
          * Intended to be called within Calculate().
          */
-        virtual std::unique_ptr<Segment> CreateSegment(
-                const Vector r, const Vector v, const double t) const = 0;
+        CalculationStatus BeginSegment(const Vector r, const Vector v,
+                                       const double t0, const double t);
+
+        /** Continues calculation of last segment until time t. */
+        CalculationStatus ContinueSegment(const double t);
+
+        /** Predicts passed Segment relative to its primary body. */
+        KinematicData PredictLocal(const Segment &segment, const double t) const;
     };
 
     // ----------------------------------------------------------------
@@ -434,29 +818,35 @@ class FlightPath {
      public:
         ManeuverSegmentGroup(const System &system,
             const Maneuver * const maneuver,
-            const Vector r, const Vector v, double t);
+            const Vector r, const Vector v, double t,
+            Arena *arena = nullptr);
+
+     private:
+        ManeuverSegmentGroup(const System &system, const Maneuver &maneuver,
+            const Vector r, const Vector v, double t, Arena *arena);
 
         /**
-         * Constructs new segment to be added to group.
-         * Intended to be called within Calculate().
+         * Returns passed maneuver, throwing std::invalid_argument if
+         * it is null.
          */
-        std::unique_ptr<Segment> CreateSegment(
-                const Vector r, const Vector v, const double t) const;
+        static const Maneuver& CheckManeuver(const Maneuver *maneuver);
     };
 
     // ----------------------------------------------------------------
 
+    /**
+     * Grouping of ballistic Segments.
+     *
+     * A group which coasts through the first half of an impulsive
+     * maneuver has that maneuver; the impulse is applied where the
+     * group ends.
+     */
     class BallisticSegmentGroup: public SegmentGroup {
      public:
         BallisticSegmentGroup(const System &system,
-            const Vector r, const Vector v, double t, double tf = -1.0);
-
-        /**
-         * Constructs new segment to be added to group.
-         * Intended to be called within Calculate().
-         */
-        std::unique_ptr<Segment> CreateSegment(
-                const Vector r, const Vector v, const double t) const;
+            const Vector r, const Vector v, double t, double tf = -1.0,
+            const Maneuver * const maneuver = nullptr,
+            Arena *arena = nullptr);
     };
     // ----------------------------------------------------------------
 };
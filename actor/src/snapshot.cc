@@ -0,0 +1,89 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "snapshot.h"
+
+#include <stdexcept>
+#include "body.h"
+#include "chebyshev.h"
+#include "ephemeris.h"
+
+namespace kin {
+
+
+SystemSnapshot::SystemSnapshot(const BodyHierarchy &hierarchy, const double t):
+        hierarchy_(&hierarchy), generation_(hierarchy.generation()), t_(t) {
+    const std::size_t n = hierarchy.size();
+    if (n == 0) {
+        return;
+    }
+
+    // Bodies with a table covering t are evaluated in the system
+    // frame directly, and marked so their parent's state is not
+    // added below.
+    std::vector<bool> in_system_frame(n, false);
+    bool all_in_system_frame = true;
+    for (BodyIndex i = 1; i < n; ++i) {
+        const ChebyshevEphemeris *table = hierarchy.body(i).system_ephemeris();
+        in_system_frame[i] = table != nullptr && table->Covers(t);
+        all_in_system_frame = all_in_system_frame && in_system_frame[i];
+    }
+
+    // Evaluate local states of all other bodies in one batch. The
+    // batch holds every body but the root, so the root's zero state
+    // is then inserted at the front.
+    r_.reserve(n);
+    v_.reserve(n);
+    if (all_in_system_frame) {
+        r_.resize(n - 1);
+        v_.resize(n - 1);
+    } else {
+        hierarchy.orbits().Predict(t, &r_, &v_);
+    }
+    r_.insert(r_.begin(), Vector::Zero());
+    v_.insert(v_.begin(), Vector::Zero());
+    for (BodyIndex i = 1; i < n; ++i) {
+        if (in_system_frame[i]) {
+            const KinematicData data =
+                hierarchy.body(i).system_ephemeris()->Predict(t);
+            r_[i] = data.r;
+            v_[i] = data.v;
+        }
+    }
+
+    // Accumulate system frame states; each parent is already done.
+    for (BodyIndex i = 1; i < n; ++i) {
+        if (!in_system_frame[i]) {
+            r_[i] += r_[hierarchy.parent(i)];
+            v_[i] += v_[hierarchy.parent(i)];
+        }
+    }
+}
+
+BodyIndex SystemSnapshot::Find(const Body &body) const {
+    if (!IsCurrent()) {
+        throw std::logic_error("SystemSnapshot::Find() : "
+            "Snapshot is stale; its hierarchy has been rebuilt.");
+    }
+    if (!hierarchy_->Contains(body)) {
+        throw std::out_of_range("SystemSnapshot::Find() : "
+            "Body " + body.id() + " is not in snapshot.");
+    }
+    return body.index();
+}
+
+
+}  // namespace kin
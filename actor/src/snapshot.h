@@ -0,0 +1,105 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_SNAPSHOT_H_
+#define ACTOR_SRC_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "body.h"
+#include "hierarchy.h"
+#include "vector.h"
+#include "util.h"
+
+namespace kin {
+
+
+/**
+ * System-frame position and velocity of every body in a system at a
+ * single time.
+ *
+ * States are stored in contiguous arrays, in the breadth-first order
+ * of the BodyHierarchy they were produced from, so each body's
+ * parent precedes it. A snapshot is produced by evaluating the local
+ * orbits of all bodies together, using the hierarchy's OrbitBatch,
+ * then making one pass over this order adding each body's local state
+ * to the already accumulated state of its parent.
+ *
+ * The snapshot keeps a pointer to the hierarchy it was created from,
+ * which must outlive it. A snapshot is stale once that hierarchy is
+ * rebuilt; see IsCurrent().
+ */
+class SystemSnapshot {
+ public:
+    /** Evaluates every body in passed hierarchy at time t. */
+    SystemSnapshot(const BodyHierarchy &hierarchy, double t);
+
+    /**
+     * Finds index of passed body in the snapshot. Throws
+     * std::out_of_range if the body is not part of the snapshot.
+     */
+    BodyIndex Find(const Body &body) const;
+
+    /**
+     * Whether the hierarchy this snapshot was created from has not
+     * since been rebuilt, so that its indices still match.
+     */
+    bool IsCurrent() const {
+        return hierarchy_->generation() == generation_;
+    }
+
+    /** Whether position r lies within the SOI of body at index i. */
+    bool InSphereOfInfluence(BodyIndex i, const Vector &r) const {
+        const double soi = hierarchy_->sphere_of_influence(i);
+        return soi >= 0.0 && (r_[i] - r).squaredNorm() < soi * soi;
+    }
+
+    // getters
+    double t() const { return t_; }
+    const BodyHierarchy& hierarchy() const { return *hierarchy_; }
+    std::size_t size() const { return r_.size(); }
+    const Body& body(BodyIndex i) const { return hierarchy_->body(i); }
+    const Vector& position(BodyIndex i) const { return r_[i]; }
+    const Vector& velocity(BodyIndex i) const { return v_[i]; }
+    KinematicData kinematic_data(BodyIndex i) const {
+        return {r_[i], v_[i]};
+    }
+    const Vector& position(const Body &body) const {
+        return r_[Find(body)];
+    }
+    const Vector& velocity(const Body &body) const {
+        return v_[Find(body)];
+    }
+    KinematicData kinematic_data(const Body &body) const {
+        return kinematic_data(Find(body));
+    }
+    /** Contiguous arrays of system-frame positions and velocities. */
+    const std::vector<Vector>& positions() const { return r_; }
+    const std::vector<Vector>& velocities() const { return v_; }
+
+ private:
+    const BodyHierarchy *hierarchy_;
+    std::uint64_t generation_;  // generation of hierarchy_ when created
+    double t_;
+    std::vector<Vector> r_;
+    std::vector<Vector> v_;
+};
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_SNAPSHOT_H_
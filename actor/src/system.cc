@@ -16,7 +16,11 @@
 
 #include "system.h"
 
+#include <stdexcept>
 #include <utility>
+#include <vector>
+#include "chebyshev.h"
+#include "influence.h"
 #include "uuid.h"
 
 namespace kin {
@@ -26,7 +30,7 @@ System::System(std::unique_ptr<Body> root):
         System(GetUUID4(), std::move(root)) {}
 
 System::System(std::string id, std::unique_ptr<Body> root):
-        root_(std::move(root)) {
+        root_(std::move(root)), hierarchy_(root_.get()) {
     id_ = id;
     universe_ = nullptr;
 }
@@ -40,26 +44,81 @@ const Body& System::FindPrimaryInfluence(const Vector r, const double t) const {
     // This method assumes that all bodies in the system are in a valid
     // state. In particular, it is assumed that children of the same
     // parent do not have overlapping spheres of influence.
-    const Body *primary = root_.get();
-    while (1) {
-        for (const BodyIdPair &child_pair : primary->children()) {
-            const Body &child = *child_pair.second;
+    BodyIndex primary = 0;
+    bool descended = true;
+    while (descended) {
+        descended = false;
+        const BodyIndex end = hierarchy_.children_end(primary);
+        for (BodyIndex i = hierarchy_.first_child(primary); i < end; ++i) {
             // check if position is within child sphere of influence
-            double sphere_radius = child.sphere_of_influence();
-            Vector child_r = child.PredictSystemPosition(t);
-            double distance_sq = (child_r - r).squaredNorm();
+            const double sphere_radius = hierarchy_.sphere_of_influence(i);
+            const Vector child_r = hierarchy_.body(i).PredictSystemPosition(t);
+            const double distance_sq = (child_r - r).squaredNorm();
             // if position is within radius of child sphere of
             // influence, repeat process, but now with child as root.
             if (distance_sq < sphere_radius * sphere_radius) {
-                primary = &child;
-                continue;
+                primary = i;
+                descended = true;
+                break;
             }
         }
-        break;  // No child soi contained passed position.
     }
-    return *primary;
+    return hierarchy_.body(primary);
 }
 
+const Body& System::FindPrimaryInfluence(
+        const SystemSnapshot &snapshot, const Vector r) const {
+    if (&snapshot.hierarchy() != &hierarchy_ || !snapshot.IsCurrent()) {
+        throw std::invalid_argument("System::FindPrimaryInfluence() : "
+            "Snapshot is not of the current hierarchy of system " + id_);
+    }
+    // Same descent as above, but reading body positions from snapshot.
+    BodyIndex primary = 0;
+    bool descended = true;
+    while (descended) {
+        descended = false;
+        const BodyIndex end = hierarchy_.children_end(primary);
+        for (BodyIndex i = hierarchy_.first_child(primary); i < end; ++i) {
+            if (snapshot.InSphereOfInfluence(i, r)) {
+                primary = i;
+                descended = true;
+                break;
+            }
+        }
+    }
+    return hierarchy_.body(primary);
+}
+
+void System::FindPrimaryInfluences(const std::vector<Vector> &positions,
+        const double t, std::vector<const Body*> *influences) const {
+    const SystemSnapshot snapshot(hierarchy_, t);
+    const InfluenceIndex index(snapshot);
+    influences->resize(positions.size());
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        (*influences)[i] =
+            &hierarchy_.body(index.FindPrimaryInfluence(positions[i]));
+    }
+}
+
+SystemSnapshot System::Snapshot(const double t) const {
+    return SystemSnapshot(hierarchy_, t);
+}
+
+std::size_t System::LoadEphemerides(std::istream *in) {
+    std::vector<ChebyshevEphemeris> tables = ReadEphemerides(in);
+    std::size_t n_attached = 0;
+    for (ChebyshevEphemeris &table : tables) {
+        // Tables for bodies not in the system are ignored.
+        if (hierarchy_.Contains(table.body_id())) {
+            Body *body = hierarchy_.mutable_body(
+                hierarchy_.Find(table.body_id()));
+            body->SetSystemEphemeris(
+                std::make_unique<ChebyshevEphemeris>(std::move(table)));
+            ++n_attached;
+        }
+    }
+    return n_attached;
+}
 bool System::AddActor(Actor *actor) {
     // TODO
     // Check that actor is in universe
@@ -17,11 +17,15 @@
 #ifndef ACTOR_SRC_SYSTEM_H_
 #define ACTOR_SRC_SYSTEM_H_
 
+#include <istream>
 #include <set>
 #include <memory>
+#include <vector>
 #include "orbit.h"
 #include "actor.h"
 #include "body.h"
+#include "hierarchy.h"
+#include "snapshot.h"
 
 namespace kin {
 
@@ -39,16 +43,62 @@ class System {
      * passed position vector.
      */
     const Body& FindPrimaryInfluence(const Vector r, double t) const;
+    /**
+     * Find body which is the primary influence at passed position
+     * vector, using body positions from passed snapshot of this
+     * system. Throws std::invalid_argument if the snapshot was not
+     * produced from the system's current hierarchy.
+     */
+    const Body& FindPrimaryInfluence(
+        const SystemSnapshot &snapshot, const Vector r) const;
+
+    /**
+     * Finds primary influence at each of passed positions at time t,
+     * writing the body for positions[i] to influences[i].
+     *
+     * Bodies are evaluated once and indexed spatially, so this is
+     * much faster than calling FindPrimaryInfluence() per position
+     * when there are many positions or bodies.
+     */
+    void FindPrimaryInfluences(const std::vector<Vector> &positions,
+        double t, std::vector<const Body*> *influences) const;
+
+    /**
+     * Evaluates system-frame position and velocity of every body in
+     * the system at time t, visiting each body once.
+     */
+    SystemSnapshot Snapshot(double t) const;
     bool AddActor(Actor *actor);
 
+    /**
+     * Rebuilds index of bodies in system. Must be called if bodies
+     * are added to the system's tree after it is constructed.
+     *
+     * Snapshots taken before the call become stale, and body indices
+     * found before it may no longer be valid.
+     */
+    void Reindex() { hierarchy_ = BodyHierarchy(root_.get()); }
+
+    /**
+     * Reads ephemeris tables in the format written by
+     * WriteEphemerides(), and attaches each to the body in this
+     * system with the matching id. Tables for bodies not in the
+     * system are ignored.
+     *
+     * Returns number of tables attached.
+     */
+    std::size_t LoadEphemerides(std::istream *in);
+
     // getters
     Vector v() const { return v_; }
     Body& root() const { return *root_; }
+    const BodyHierarchy& hierarchy() const { return hierarchy_; }
     const std::string id() const { return id_; }
  private:
     std::string id_;
     Universe *universe_;  // reference back to parent universe
     std::unique_ptr<Body> root_;  // root body object - others may have raw ptr
+    BodyHierarchy hierarchy_;  // flattened index of bodies under root_
     Vector v_;  // system velocity relative to the avg of the stellar medium.
     std::set<std::string> actor_ids;  // allows lookup of actor in universe
 };
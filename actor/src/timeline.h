@@ -0,0 +1,142 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_TIMELINE_H_
+#define ACTOR_SRC_TIMELINE_H_
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace kin {
+
+
+/**
+ * Sequence of values, each of which begins at a point in time, stored
+ * in order of time in contiguous arrays.
+ *
+ * Values are only ever added after the last value, so the start times
+ * remain sorted without any rebalancing, and are stored apart from
+ * the values so that lookups search a compact array of doubles.
+ *
+ * Both arrays are allocated with the passed allocator.
+ */
+template <typename T, typename Allocator = std::allocator<T> >
+class Timeline {
+ public:
+    using const_iterator =
+        typename std::vector<T, Allocator>::const_iterator;
+
+    explicit Timeline(const Allocator &allocator = Allocator()):
+        times_(TimeAllocator(allocator)), values_(allocator) {}
+
+    /**
+     * Appends value beginning at time t. Throws std::invalid_argument
+     * if t precedes the start of the last value.
+     */
+    void Append(const double t, T value) {
+        if (!times_.empty() && t < times_.back()) {
+            throw std::invalid_argument("Timeline::Append() : "
+                "Passed t (" + std::to_string(t) + ") precedes last "
+                "value's start (" + std::to_string(times_.back()) + ")");
+        }
+        times_.push_back(t);
+        values_.push_back(std::move(value));
+    }
+
+    /**
+     * Finds number of values beginning at or before time t; the
+     * index of the value in effect at t is one less than this.
+     *
+     * The binary search narrows the range with a conditional move
+     * rather than a branch, so its run time does not depend on how
+     * predictable the comparisons are.
+     */
+    std::size_t UpperBound(const double t) const {
+        if (times_.empty()) {
+            return 0;
+        }
+        const double *base = times_.data();
+        std::size_t n = times_.size();
+        while (n > 1) {
+            const std::size_t half = n / 2;
+            base = base[half] <= t ? base + half : base;
+            n -= half;
+        }
+        return (base - times_.data()) + (*base <= t ? 1 : 0);
+    }
+
+    /**
+     * Finds the same as UpperBound(t), first checking whether hint, a
+     * previous result, or the one following it is correct, so that a
+     * series of increasing times is found in amortized constant time.
+     */
+    std::size_t UpperBound(const double t, const std::size_t hint) const {
+        if (hint > 0 && hint <= times_.size() && times_[hint - 1] <= t) {
+            for (std::size_t i = hint; i < hint + 2; ++i) {
+                if (i == times_.size() || t < times_[i]) {
+                    return i;
+                }
+            }
+        }
+        return UpperBound(t);
+    }
+
+    /** Removes values from index i onwards. */
+    void Truncate(const std::size_t i) {
+        if (i < times_.size()) {
+            times_.resize(i);
+            values_.erase(values_.begin() + i, values_.end());
+        }
+    }
+
+    /** Removes value at index i, keeping the order of the others. */
+    void Erase(const std::size_t i) {
+        times_.erase(times_.begin() + i);
+        values_.erase(values_.begin() + i);
+    }
+
+    void Clear() {
+        times_.clear();
+        values_.clear();
+    }
+
+    // getters
+    std::size_t size() const { return values_.size(); }
+    bool empty() const { return values_.empty(); }
+    double t(const std::size_t i) const { return times_[i]; }
+    const T& operator[](const std::size_t i) const { return values_[i]; }
+    T& operator[](const std::size_t i) { return values_[i]; }
+    const T& back() const { return values_.back(); }
+    T& back() { return values_.back(); }
+    const_iterator begin() const { return values_.begin(); }
+    const_iterator end() const { return values_.end(); }
+
+ private:
+    using TimeAllocator = typename std::allocator_traits<
+        Allocator>::template rebind_alloc<double>;
+
+    std::vector<double, TimeAllocator> times_;
+    std::vector<T, Allocator> values_;
+};
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_TIMELINE_H_
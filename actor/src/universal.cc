@@ -0,0 +1,237 @@
+/**
+    Copyright 2018 TryExceptElse
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "universal.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "const.h"
+
+namespace kin {
+
+
+// Below this |z|, Stumpff functions are evaluated from their series,
+// avoiding cancellation in 1 - cos(sqrt(z)).
+static constexpr double kStumpffSeriesLimit = 1e-3;
+// Laguerre corrections allowed per solve. From the starter used
+// below, five suffice for all conic types (checked offline over
+// randomized states with 0 <= e <= 3 and 1e-2 to 1e4 time units).
+static constexpr int kMaxUniversalIterations = 8;
+// Order used by Laguerre's method; 5 is conventional for Kepler's
+// equation (Conway, 1986).
+static constexpr double kLaguerreOrder = 5.;
+
+
+void Stumpff(const double z, double *c2, double *c3) {
+    if (z > kStumpffSeriesLimit) {
+        const double root_z = std::sqrt(z);
+        *c2 = (1. - std::cos(root_z)) / z;
+        *c3 = (root_z - std::sin(root_z)) / (root_z * z);
+    } else if (z < -kStumpffSeriesLimit) {
+        const double root_z = std::sqrt(-z);
+        *c2 = (std::cosh(root_z) - 1.) / -z;
+        *c3 = (std::sinh(root_z) - root_z) / (root_z * -z);
+    } else {
+        *c2 = 1. / 2. - z * (1. / 24. - z * (1. / 720. -
+            z * (1. / 40320. - z / 3628800.)));
+        *c3 = 1. / 6. - z * (1. / 120. - z * (1. / 5040. -
+            z * (1. / 362880. - z / 39916800.)));
+    }
+}
+
+
+double FindCharacteristicPeriod(
+        const double u, const Vector &r, const Vector &v) {
+    const double alpha = std::fabs(2. / r.norm() - v.squaredNorm() / u);
+    if (alpha == 0.) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return TAU / std::sqrt(u * alpha * alpha * alpha);
+}
+
+
+UniversalPropagator::UniversalPropagator(
+        const double u, const Vector &r, const Vector &v):
+        r_(r), v_(v), sqrt_u_(std::sqrt(u)), r_norm_(r.norm()),
+        sigma_(r.dot(v) / std::sqrt(u)),
+        alpha_(2. / r.norm() - v.squaredNorm() / u),
+        anomaly0_(0.), period_(0.) {
+    if (r_norm_ == 0.) {
+        throw std::invalid_argument("UniversalPropagator : "
+            "Initialized with r of [0,0,0]");
+    }
+    // e cos(E0) and e sin(E0) (or e cosh(H0), e sinh(H0)) follow
+    // directly from the state vector.
+    const double e_cos = 1. - r_norm_ * alpha_;
+    const double e_sin = sigma_ * std::sqrt(std::fabs(alpha_));
+    if (alpha_ > 0.) {
+        e_ = std::hypot(e_cos, e_sin);
+        anomaly0_ = std::atan2(e_sin, e_cos);
+        period_ = TAU / (sqrt_u_ * alpha_ * std::sqrt(alpha_));
+    } else {
+        e_ = std::sqrt(std::fmax(0., e_cos * e_cos - e_sin * e_sin));
+        if (alpha_ < 0.) {
+            anomaly0_ = std::asinh(e_sin / e_);
+        }
+    }
+}
+
+KinematicData UniversalPropagator::Predict(const double time,
+        const KeplerTolerance tolerance, int *iterations) const {
+    const double dt = ReduceTime(time);
+    return Evaluate(dt, SolveUniversalAnomaly(dt, tolerance, iterations));
+}
+
+double UniversalPropagator::FindUniversalAnomaly(const double time,
+        const KeplerTolerance tolerance, int *iterations) const {
+    return SolveUniversalAnomaly(ReduceTime(time), tolerance, iterations);
+}
+
+/**
+ * Solves for the universal anomaly after passed time, which must
+ * already be reduced. Reducing twice is not safe: a time of exactly
+ * half a period may be rounded to the opposite half.
+ */
+double UniversalPropagator::SolveUniversalAnomaly(const double dt,
+        const KeplerTolerance tolerance, int *iterations) const {
+    // chi is scaled like sqrt(distance); sqrt(|r|) makes the
+    // threshold comparable to one in radians of anomaly.
+    const double scale = std::sqrt(r_norm_);
+    const double thresh = AnomalyThreshold(tolerance);
+    double chi = EstimateUniversalAnomaly(dt);
+    int n_iter = 0;
+    while (n_iter < kMaxUniversalIterations) {
+        const double delta = CorrectUniversalAnomaly(dt, chi);
+        chi -= delta;
+        ++n_iter;
+        if (std::fabs(delta) <= thresh * std::fmax(std::fabs(chi), scale)) {
+            break;
+        }
+    }
+    if (iterations != nullptr) {
+        *iterations = n_iter;
+    }
+    return chi;
+}
+
+/**
+ * Removes whole periods from the passed time if the orbit is bound,
+ * so that the universal anomaly stays within one revolution.
+ */
+double UniversalPropagator::ReduceTime(const double time) const {
+    if (period_ == 0.) {
+        return time;
+    }
+    return time - period_ * std::round(time / period_);
+}
+
+/**
+ * Estimates the universal anomaly after passed (reduced) time.
+ *
+ * Two estimates are made: one from the root of the parabolic
+ * (alpha = 0) form of the universal Kepler equation, which is exact
+ * for parabolas and accurate whenever |alpha chi^2| is small, and one
+ * from the eccentric or hyperbolic anomaly, which is accurate
+ * elsewhere. The estimate with the smaller Newton step is used.
+ */
+double UniversalPropagator::EstimateUniversalAnomaly(const double time) const {
+    // Parabolic estimate; root of y^3 + p y + q = 0, chi = y - sigma.
+    const double p = 3. * (2. * r_norm_ - sigma_ * sigma_);
+    const double q = 2. * sigma_ * sigma_ * sigma_ -
+        6. * r_norm_ * sigma_ - 6. * sqrt_u_ * time;
+    const double disc = std::sqrt(std::fabs(q * q / 4. + p * p * p / 27.));
+    const double parabolic_chi =
+        std::cbrt(-q / 2. + disc) + std::cbrt(-q / 2. - disc) - sigma_;
+
+    // Estimate from anomaly, skipped where e is not consistent with
+    // the sign of alpha due to round-off.
+    if (alpha_ == 0. || (alpha_ > 0.) != (e_ < 1.)) {
+        return parabolic_chi;
+    }
+    const double root_alpha = std::sqrt(std::fabs(alpha_));
+    const double n = sqrt_u_ * std::fabs(alpha_) * root_alpha;
+    const double e_sin = sigma_ * root_alpha;
+    const double m0 = alpha_ > 0. ? anomaly0_ - e_sin : e_sin - anomaly0_;
+    const double anomaly = SolveKepler(e_, m0 + n * time, kRenderTolerance);
+    const double conic_chi = (anomaly - anomaly0_) / root_alpha;
+
+    return Residual(time, conic_chi) < Residual(time, parabolic_chi) ?
+        conic_chi : parabolic_chi;
+}
+
+/**
+ * Gets the size of the Newton step that would be taken from passed
+ * estimate of the universal anomaly.
+ */
+double UniversalPropagator::Residual(
+        const double time, const double chi) const {
+    const double z = alpha_ * chi * chi;
+    double c2, c3;
+    Stumpff(z, &c2, &c3);
+    const double f = sigma_ * chi * chi * c2 +
+        (1. - alpha_ * r_norm_) * chi * chi * chi * c3 +
+        r_norm_ * chi - sqrt_u_ * time;
+    const double df = sigma_ * chi * (1. - z * c3) +
+        (1. - alpha_ * r_norm_) * chi * chi * c2 + r_norm_;
+    const double step = std::fabs(f / df);
+    return std::isfinite(step) ? step : std::numeric_limits<double>::max();
+}
+
+/**
+ * Gets the Laguerre correction to passed estimate of the universal
+ * anomaly; the result is subtracted from the estimate.
+ */
+double UniversalPropagator::CorrectUniversalAnomaly(
+        const double time, const double chi) const {
+    const double z = alpha_ * chi * chi;
+    double c2, c3;
+    Stumpff(z, &c2, &c3);
+    const double k = 1. - alpha_ * r_norm_;
+    // F(chi), and its first (the radius) and second derivatives.
+    const double f = sigma_ * chi * chi * c2 + k * chi * chi * chi * c3 +
+        r_norm_ * chi - sqrt_u_ * time;
+    const double df = sigma_ * chi * (1. - z * c3) + k * chi * chi * c2 +
+        r_norm_;
+    const double ddf = sigma_ * (1. - z * c2) + k * chi * (1. - z * c3);
+    const double n = kLaguerreOrder;
+    const double root = std::sqrt(std::fabs(
+        (n - 1.) * (n - 1.) * df * df - n * (n - 1.) * f * ddf));
+    return n * f / (df + std::copysign(root, df));
+}
+
+/**
+ * Evaluates position and velocity at passed (reduced) time and
+ * universal anomaly using the Lagrange f and g coefficients.
+ */
+KinematicData UniversalPropagator::Evaluate(
+        const double time, const double chi) const {
+    const double chi2 = chi * chi;
+    const double z = alpha_ * chi2;
+    double c2, c3;
+    Stumpff(z, &c2, &c3);
+    const double f = 1. - chi2 / r_norm_ * c2;
+    const double g = time - chi2 * chi * c3 / sqrt_u_;
+    const Vector r = f * r_ + g * v_;
+    const double r_norm = r.norm();
+    const double df = sqrt_u_ / (r_norm * r_norm_) * chi * (z * c3 - 1.);
+    const double dg = 1. - chi2 / r_norm * c2;
+    return {r, df * r_ + dg * v_};
+}
+
+
+}  // namespace kin
@@ -0,0 +1,106 @@
+/**
+   Copyright 2018 TryExceptElse
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ACTOR_SRC_UNIVERSAL_H_
+#define ACTOR_SRC_UNIVERSAL_H_
+
+#include "kepler.h"
+#include "vector.h"
+#include "util.h"
+
+namespace kin {
+
+
+/**
+ * Evaluates the Stumpff functions
+ * c2(z) = (1 - cos(sqrt(z))) / z and
+ * c3(z) = (sqrt(z) - sin(sqrt(z))) / sqrt(z)^3,
+ * continued through z = 0 to their hyperbolic forms for z < 0.
+ */
+void Stumpff(const double z, double *c2, double *c3);
+
+/**
+ * Finds the period of the orbit described by passed position and
+ * velocity (relative to a body with gravitational parameter u),
+ * without calculating orbital elements.
+ *
+ * For unbound orbits, 2 PI divided by the mean motion is returned
+ * instead; this is infinite if the orbit is parabolic.
+ */
+double FindCharacteristicPeriod(
+    const double u, const Vector &r, const Vector &v);
+
+
+/**
+ * Propagates a state vector along the conic it defines, using the
+ * universal anomaly (chi) formulation of Kepler's problem.
+ *
+ * The same equations describe elliptic, parabolic and hyperbolic
+ * motion, so no branch is taken on eccentricity, and orbits with
+ * e at or near 1 are propagated with the same accuracy as any other.
+ *
+ * https://en.wikipedia.org/wiki/Universal_variable_formulation
+ */
+class UniversalPropagator {
+ public:
+    UniversalPropagator(const double u, const Vector &r, const Vector &v);
+
+    /**
+     * Predicts position and velocity after passed time, relative to
+     * the same reference as the vectors passed on construction.
+     *
+     * If iterations is not null, the number of corrections applied
+     * to the universal anomaly is written to it.
+     */
+    KinematicData Predict(const double time,
+        const KeplerTolerance tolerance = kPhysicsTolerance,
+        int *iterations = nullptr) const;
+
+    /** Finds the universal anomaly (chi) reached after passed time. */
+    double FindUniversalAnomaly(const double time,
+        const KeplerTolerance tolerance = kPhysicsTolerance,
+        int *iterations = nullptr) const;
+
+    // getters
+    /** Reciprocal of the semi-major axis; 0 for parabolic orbits. */
+    double alpha() const { return alpha_; }
+    double eccentricity() const { return e_; }
+    const Vector& position() const { return r_; }
+    const Vector& velocity() const { return v_; }
+
+ private:
+    Vector r_, v_;      // state at epoch
+    double sqrt_u_;     // square root of gravitational parameter
+    double r_norm_;     // |r| at epoch
+    double sigma_;      // r.v / sqrt(u) at epoch
+    double alpha_;      // 2 / |r| - |v|^2 / u
+    double e_;          // eccentricity
+    double anomaly0_;   // eccentric / hyperbolic anomaly at epoch
+    double period_;     // orbital period if bound; otherwise 0
+
+    double ReduceTime(const double time) const;
+    double SolveUniversalAnomaly(const double dt,
+        const KeplerTolerance tolerance, int *iterations) const;
+    double EstimateUniversalAnomaly(const double time) const;
+    double Residual(const double time, const double chi) const;
+    double CorrectUniversalAnomaly(const double time, const double chi) const;
+    KinematicData Evaluate(const double time, const double chi) const;
+};
+
+
+}  // namespace kin
+
+#endif  // ACTOR_SRC_UNIVERSAL_H_
@@ -27,8 +27,8 @@ namespace kin {
  * Structure containing kinematic information about an object.
  */
 struct KinematicData {
-    Vector r;
-    Vector v;
+    Vector r = Vector::Zero();
+    Vector v = Vector::Zero();
 
     const KinematicData operator+(const KinematicData rhs) const {
         return {r + rhs.r, v + rhs.v};
@@ -39,6 +39,23 @@ struct KinematicData {
     }
 };
 
+/**
+ * Structure containing the state of an orbiting object at a point in
+ * time, as produced by propagating an orbit.
+ *
+ * Unlike a predicted Orbit, this contains only the values which
+ * change as an orbit is advanced.
+ */
+struct OrbitState {
+    double mean_anomaly;
+    double eccentric_anomaly;  // Hyperbolic anomaly when e > 1.
+    double true_anomaly;
+    Vector r;
+    Vector v;
+
+    KinematicData kinematic_data() const { return {r, v}; }
+};
+
 
 }  // namespace kin
 
@@ -0,0 +1,38 @@
+#ifndef ACTOR_TEST_FIXTURES_H_
+#define ACTOR_TEST_FIXTURES_H_
+
+#include <memory>
+#include <utility>
+
+#include "body.h"
+#include "orbit.h"
+#include "system.h"
+#include "vector.h"
+
+
+/**
+ * Creates the sun, with the earth orbiting it and the moon orbiting
+ * the earth, with ids "sun", "earth" and "moon". Returns the sun.
+ */
+inline std::unique_ptr<kin::Body> CreateSunEarthMoon() {
+    auto sun = std::make_unique<kin::Body>("sun", 1.32712440018e20, 6.957e8);
+    kin::Orbit earth_orbit(*sun,
+        kin::Vector(1.496e11, 0.0, 0.0), kin::Vector(0.0, 29780.0, 500.0));
+    auto earth = std::make_unique<kin::Body>(
+        "earth", 3.986004418e14, 6.371e6, sun.get(), &earth_orbit);
+    kin::Orbit moon_orbit(*earth,
+        kin::Vector(3.844e8, 0.0, 0.0), kin::Vector(0.0, 1022.0, 90.0));
+    auto moon = std::make_unique<kin::Body>(
+        "moon", 4.9048695e12, 1.7374e6, earth.get(), &moon_orbit);
+    earth->AddChild(std::move(moon));
+    sun->AddChild(std::move(earth));
+    return sun;
+}
+
+/** Creates a system of the bodies from CreateSunEarthMoon(). */
+inline std::unique_ptr<kin::System> CreateEarthMoonSystem() {
+    return std::make_unique<kin::System>(CreateSunEarthMoon());
+}
+
+
+#endif  // ACTOR_TEST_FIXTURES_H_
@@ -0,0 +1,85 @@
+#include <cstdint>
+#include <vector>
+#include "catch.hpp"
+
+#include "arena.h"
+
+
+namespace {
+
+struct Counted {
+    explicit Counted(int *count): count(count) { ++*count; }
+    ~Counted() { --*count; }
+    int *count;
+};
+
+}  // namespace
+
+
+TEST_CASE( "test arena allocations are aligned", "[Arena]" ) {
+    kin::Arena arena(256);
+    for (std::size_t alignment = 1; alignment <= 64; alignment *= 2) {
+        void *p = arena.Allocate(3, alignment);
+        REQUIRE( reinterpret_cast<std::uintptr_t>(p) % alignment == 0 );
+    }
+    REQUIRE( arena.n_allocations() == 7 );
+    REQUIRE( arena.bytes_allocated() == 21 );
+}
+
+TEST_CASE( "test arena reuses blocks after reset", "[Arena]" ) {
+    kin::Arena arena(1024);
+    for (int i = 0; i < 100; ++i) {
+        arena.Allocate(100, 8);
+    }
+    // An allocation larger than a block gets its own block.
+    arena.Allocate(5000, 8);
+    const std::size_t capacity = arena.capacity();
+    const std::size_t n_blocks = arena.n_blocks();
+    REQUIRE( capacity >= 15000 );
+
+    for (int reset = 0; reset < 3; ++reset) {
+        arena.Reset();
+        REQUIRE( arena.bytes_allocated() == 0 );
+        for (int i = 0; i < 100; ++i) {
+            arena.Allocate(100, 8);
+        }
+        arena.Allocate(5000, 8);
+        REQUIRE( arena.capacity() == capacity );
+        REQUIRE( arena.n_blocks() == n_blocks );
+    }
+    REQUIRE( arena.n_resets() == 3 );
+}
+
+TEST_CASE( "test arena destroys created objects", "[Arena]" ) {
+    int count = 0;
+    {
+        kin::Arena arena;
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE( arena.Create<Counted>(&count)->count == &count );
+        }
+        REQUIRE( count == 10 );
+        arena.Reset();
+        REQUIRE( count == 0 );
+        arena.Create<Counted>(&count);
+        arena.Create<Counted>(&count);
+        REQUIRE( count == 2 );
+    }
+    REQUIRE( count == 0 );
+}
+
+TEST_CASE( "test arena allocator holds container", "[Arena]" ) {
+    kin::Arena arena;
+    std::vector<double, kin::ArenaAllocator<double> > values(
+        (kin::ArenaAllocator<double>(&arena)));
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    REQUIRE( values[999] == 999.0 );
+    REQUIRE( arena.bytes_allocated() >= 1000 * sizeof(double) );
+
+    // Without an arena, the heap is used.
+    std::vector<double, kin::ArenaAllocator<double> > heap_values;
+    heap_values.assign(1000, 1.0);
+    REQUIRE( heap_values.get_allocator().arena() == nullptr );
+    REQUIRE( values.get_allocator() != heap_values.get_allocator() );
+}
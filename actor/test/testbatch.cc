@@ -0,0 +1,145 @@
+#include <cmath>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "batch.h"
+#include "body.h"
+#include "const.h"
+#include "orbit.h"
+#include "universal.h"
+#include "vector.h"
+
+
+TEST_CASE( "test batch prediction matches orbit prediction", "[OrbitBatch]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    const std::vector<kin::Orbit> orbits = {
+        kin::Orbit(body,
+            kin::Vector(617244712358.0, -431694791368.0, -12036457087.0),
+            kin::Vector(7320.0, 11329.0, -0211.0)),
+        kin::Orbit(body,
+            kin::Vector(617244712358.0, -431694791368.0, -402036457087.0),
+            kin::Vector(7320.0, 11329.0, -0211.0)),
+        kin::Orbit(body,
+            kin::Vector(617244712358.0, -431694791368.0, -12036457087.0),
+            kin::Vector(2320.0, 17329.0, -2011.0)),
+    };
+    kin::OrbitBatch batch;
+    for (const kin::Orbit &orbit : orbits) {
+        batch.Add(orbit);
+    }
+    const double t = 374942509.78053558 / 3;
+    std::vector<kin::Vector> r, v;
+    batch.Predict(t, &r, &v);
+
+    REQUIRE( r.size() == orbits.size() );
+    REQUIRE( v.size() == orbits.size() );
+    for (std::size_t i = 0; i < orbits.size(); ++i) {
+        const kin::Orbit prediction = orbits[i].Predict(t);
+        const kin::Vector expected_r = prediction.position();
+        const kin::Vector expected_v = prediction.velocity();
+        REQUIRE( (r[i] - expected_r).norm() < expected_r.norm() * 1e-6 );
+        REQUIRE( (v[i] - expected_v).norm() < expected_v.norm() * 1e-6 );
+    }
+}
+
+TEST_CASE( "test batch prediction applies orbit epoch", "[OrbitBatch]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    const kin::Vector r0(617244712358.0, -431694791368.0, -12036457087.0);
+    const kin::Vector v0(7320.0, 11329.0, -0211.0);
+    const kin::Orbit orbit(body, r0, v0);
+    const double t0 = 1000000.0;
+    kin::OrbitBatch batch;
+    batch.Add(orbit, t0);
+
+    std::vector<kin::Vector> r, v;
+    batch.Predict(t0, &r, &v);
+
+    REQUIRE( r[0].x() == Approx(r0.x()).epsilon(0.0001) );
+    REQUIRE( r[0].y() == Approx(r0.y()).epsilon(0.0001) );
+    REQUIRE( r[0].z() == Approx(r0.z()).epsilon(0.0001) );
+    REQUIRE( v[0].x() == Approx(v0.x()).epsilon(0.0001) );
+    REQUIRE( v[0].y() == Approx(v0.y()).epsilon(0.0001) );
+    REQUIRE( v[0].z() == Approx(v0.z()).epsilon(0.0001) );
+}
+
+TEST_CASE( "test batch handles many orbits", "[OrbitBatch]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    const kin::Orbit orbit(body,
+        kin::Vector(617244712358.0, -431694791368.0, -12036457087.0),
+        kin::Vector(7320.0, 11329.0, -0211.0));
+    const int n_orbits = 1000;
+    kin::OrbitBatch batch(n_orbits);
+    for (int i = 0; i < n_orbits; ++i) {
+        batch.Add(orbit, i * 1000.0);
+    }
+    const double t = 374942509.78053558 / 2;
+    std::vector<kin::Vector> r, v;
+    batch.Predict(t, &r, &v);
+
+    REQUIRE( r.size() == n_orbits );
+    for (int i = 0; i < n_orbits; i += 97) {
+        const kin::Vector expected = orbit.Predict(t - i * 1000.0).position();
+        REQUIRE( (r[i] - expected).norm() < expected.norm() * 1e-6 );
+    }
+}
+
+TEST_CASE( "test batch propagates mixed conic types", "[OrbitBatch]" ) {
+    const double u = 2.0;
+    // Elliptic, parabolic (e == 1 exactly) and hyperbolic orbits.
+    const std::vector<kin::Orbit> orbits = {
+        kin::Orbit(u, kin::Vector(1.0, 0.0, 0.0), kin::Vector(0.0, 1.7, 0.2)),
+        kin::Orbit(u, kin::Vector(1.0, 0.0, 0.0), kin::Vector(0.0, 2.0, 0.0)),
+        kin::Orbit(u, kin::Vector(1.0, 0.0, 0.0), kin::Vector(0.0, 2.6, 0.1)),
+    };
+    REQUIRE( orbits[1].eccentricity() == 1.0 );
+    kin::OrbitBatch batch;
+    for (const kin::Orbit &orbit : orbits) {
+        batch.Add(orbit);
+    }
+    std::vector<kin::Vector> r, v;
+    for (const double t : {-3.0, 0.5, 4.0 / 3.0, 20.0}) {
+        batch.Predict(t, &r, &v);
+        for (std::size_t i = 0; i < orbits.size(); ++i) {
+            const kin::OrbitState expected = orbits[i].PredictState(t);
+            REQUIRE( (r[i] - expected.r).norm() < expected.r.norm() * 1e-9 );
+            REQUIRE( (v[i] - expected.v).norm() < expected.v.norm() * 1e-9 );
+        }
+    }
+}
+
+TEST_CASE( "test batch matches universal propagator", "[OrbitBatch]" ) {
+    const double u = 1.0;
+    std::vector<kin::UniversalPropagator> propagators;
+    kin::OrbitBatch batch;
+    for (int i = 1; i <= 60; ++i) {
+        // Eccentricities from 0.05 to 3, taken at several points
+        // along each orbit.
+        const double e = 3.0 * i / 60;
+        for (const double true_anomaly : {0.0, 1.0, -2.0, 2.5}) {
+            const double p = 1.0 + e;
+            const double denominator = 1.0 + e * std::cos(true_anomaly);
+            if (denominator <= 0.1) {
+                continue;
+            }
+            const double distance = p / denominator;
+            const kin::Vector r(distance * std::cos(true_anomaly),
+                                distance * std::sin(true_anomaly), 0.0);
+            const kin::Vector v(-std::sin(true_anomaly) / std::sqrt(p),
+                                (e + std::cos(true_anomaly)) / std::sqrt(p),
+                                0.0);
+            propagators.emplace_back(u, r, v);
+            batch.Add(kin::Orbit(u, r, v));
+        }
+    }
+    std::vector<kin::Vector> r, v;
+    for (int j = -12; j <= 12; ++j) {
+        const double t = std::copysign(std::pow(10.0, std::abs(j) / 3.0), j);
+        batch.Predict(t, &r, &v);
+        for (std::size_t i = 0; i < propagators.size(); ++i) {
+            const kin::KinematicData expected = propagators[i].Predict(t);
+            REQUIRE( (r[i] - expected.r).norm() < expected.r.norm() * 1e-9 );
+            REQUIRE( (v[i] - expected.v).norm() < expected.v.norm() * 1e-9 );
+        }
+    }
+}
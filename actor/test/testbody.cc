@@ -25,6 +25,47 @@ TEST_CASE( "Body sphere of influence handles no parent case", "[Body]" ) {
     REQUIRE( body.sphere_of_influence() == -1.0 );
 }
 
+TEST_CASE( "Body sphere of influence is calculated", "[Body]" ) {
+    kin::Body sun("sun", 1.32712440018e20, 6.957e8);
+    kin::Orbit orbit(sun, 1.496e11, 0.0167, 0.0, 0.0, 0.0, 0.0);
+    kin::Body earth("earth", 3.986004418e14, 6.371e6, &sun, &orbit);
+    // a * (m / M) ^ (2 / 5); about 9.25e8 m for earth.
+    REQUIRE( earth.sphere_of_influence() == Approx(9.245e8).epsilon(1e-3) );
+}
+
+TEST_CASE( "Body can be created with orbit from elements", "[Body]" ) {
+    kin::Body sun("sun", 1.32712440018e20, 6.957e8);
+    kin::Orbit orbit(sun, 1.496e11, 0.0167, 0.1, 0.5, 1.0, 2.0);
+    kin::Body earth("earth", 3.986004418e14, 6.371e6, &sun, &orbit);
+
+    const kin::KinematicData data = earth.PredictLocalKinematicData(1e6);
+    const kin::Orbit prediction = orbit.Predict(1e6);
+    REQUIRE( (data.r - prediction.position()).norm() < 1.0 );
+    REQUIRE( (data.v - prediction.velocity()).norm() < 1e-6 );
+}
+
+TEST_CASE( "Body with parabolic orbit is not compiled", "[Body]" ) {
+    // e == 1 exactly; periapsis of 1, semi-latus rectum of 2.
+    kin::Body sun("sun", 2.0, 0.1);
+    kin::Orbit orbit(sun, kin::Vector(1, 0, 0), kin::Vector(0, 2, 0));
+    kin::Body comet("comet", 1e-9, 1e-3, &sun, &orbit);
+    REQUIRE( comet.ephemeris() == nullptr );
+
+    // Barker's equation places true anomaly at 90 degrees after 4/3.
+    const kin::KinematicData data = comet.PredictLocalKinematicData(4.0 / 3.0);
+    REQUIRE( data.r.x() == Approx(0.0).margin(1e-9) );
+    REQUIRE( data.r.y() == Approx(2.0) );
+    REQUIRE( data.v.x() == Approx(-1.0) );
+    REQUIRE( data.v.y() == Approx(1.0) );
+}
+
+TEST_CASE( "Body orbit cannot be parabolic from elements", "[Body]" ) {
+    kin::Body sun("sun", 1.32712440018e20, 6.957e8);
+    REQUIRE_THROWS_AS(
+        kin::Orbit(sun, 1.496e11, 1.0, 0.0, 0.0, 0.0, 0.0),
+        std::invalid_argument);
+}
+
 TEST_CASE( "Body child can be added", "[Body]" ) {
     kin::Body parent_body("1", kin::G * 100.0, 100.0);
     std::unique_ptr<kin::Body> child_body_ptr =
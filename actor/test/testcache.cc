@@ -0,0 +1,90 @@
+#include <memory>
+#include "catch.hpp"
+
+#include "body.h"
+#include "cache.h"
+#include "orbit.h"
+#include "vector.h"
+
+#include "fixtures.h"
+
+
+TEST_CASE( "test cache finds inserted data", "[Cache]" ) {
+    kin::BodyStateCache cache;
+    kin::KinematicData data;
+    data.r = kin::Vector(1.0, 2.0, 3.0);
+    data.v = kin::Vector(4.0, 5.0, 6.0);
+
+    kin::KinematicData result;
+    REQUIRE_FALSE( cache.Find(7, 1.5, &result) );
+    cache.Insert(7, 1.5, data);
+    REQUIRE( cache.Find(7, 1.5, &result) );
+    REQUIRE( result.r == data.r );
+    REQUIRE( result.v == data.v );
+    REQUIRE_FALSE( cache.Find(8, 1.5, &result) );
+    REQUIRE_FALSE( cache.Find(7, 1.5000001, &result) );
+    REQUIRE( cache.hits() == 1 );
+    REQUIRE( cache.misses() == 3 );
+
+    cache.Clear();
+    REQUIRE_FALSE( cache.Find(7, 1.5, &result) );
+    cache.ResetCounters();
+    REQUIRE( cache.hits() == 0 );
+    REQUIRE( cache.misses() == 0 );
+}
+
+TEST_CASE( "test cache is bounded", "[Cache]" ) {
+    kin::BodyStateCache cache;
+    const std::size_t n = kin::BodyStateCache::kCapacity * 4;
+    for (std::size_t i = 0; i < n; ++i) {
+        cache.Insert(1, static_cast<double>(i), kin::KinematicData());
+    }
+    kin::KinematicData result;
+    std::size_t n_found = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (cache.Find(1, static_cast<double>(i), &result)) {
+            ++n_found;
+        }
+    }
+    REQUIRE( n_found <= kin::BodyStateCache::kCapacity );
+    REQUIRE( n_found > 0 );
+}
+
+TEST_CASE( "test disabled cache stores nothing", "[Cache]" ) {
+    kin::BodyStateCache cache;
+    cache.set_enabled(false);
+    cache.Insert(1, 0.0, kin::KinematicData());
+    cache.set_enabled(true);
+    kin::KinematicData result;
+    REQUIRE_FALSE( cache.Find(1, 0.0, &result) );
+}
+
+TEST_CASE( "test repeated body predictions hit cache", "[Cache]" ) {
+    const std::unique_ptr<kin::Body> sun = CreateSunEarthMoon();
+    const kin::Body &earth = *sun->children().at("earth");
+    const kin::Body &moon = *earth.children().at("moon");
+    REQUIRE( moon.serial() != earth.serial() );
+
+    kin::BodyStateCache &cache = kin::BodyStateCache::Local();
+    cache.Clear();
+    cache.ResetCounters();
+    const double t = 123456.0;
+    const kin::KinematicData first = moon.PredictSystemKinematicData(t);
+    REQUIRE( cache.hits() == 0 );
+    REQUIRE( cache.misses() == 2 );  // moon and earth
+
+    const kin::KinematicData second = moon.PredictSystemKinematicData(t);
+    REQUIRE( moon.PredictSystemPosition(t) == first.r );
+    REQUIRE( earth.PredictLocalVelocity(t) == earth.ephemeris()->Predict(t).v );
+    REQUIRE( cache.misses() == 2 );
+    REQUIRE( cache.hits() == 5 );
+    REQUIRE( second.r == first.r );
+    REQUIRE( second.v == first.v );
+
+    // Disabled cache produces the same results.
+    cache.set_enabled(false);
+    const kin::KinematicData uncached = moon.PredictSystemKinematicData(t);
+    cache.set_enabled(true);
+    REQUIRE( uncached.r == first.r );
+    REQUIRE( uncached.v == first.v );
+}
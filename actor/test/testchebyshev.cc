@@ -0,0 +1,212 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "body.h"
+#include "chebyshev.h"
+#include "const.h"
+#include "orbit.h"
+#include "system.h"
+#include "vector.h"
+
+#include "fixtures.h"
+
+
+static const kin::Body& Child(const kin::Body &body, const std::string &id) {
+    return *body.children().at(id);
+}
+
+
+TEST_CASE( "test chebyshev table is within error bound", "[Chebyshev]" ) {
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    const kin::Body &moon = Child(Child(system->root(), "earth"), "moon");
+    const double year = 3.15576e7;
+    const kin::ChebyshevEphemeris table(moon, 0.0, year, 10.0, 1e-3);
+
+    REQUIRE( table.body_id() == "moon" );
+    REQUIRE( table.error_bound() <= 10.0 );
+    REQUIRE( table.velocity_error_bound() <= 1e-3 );
+    REQUIRE( table.n_windows() > 1 );
+    for (int i = 0; i <= 997; ++i) {
+        const double t = year * i / 997;
+        const kin::KinematicData expected = moon.PredictSystemKinematicData(t);
+        const kin::KinematicData result = table.Predict(t);
+        REQUIRE( (result.r - expected.r).norm() < 10.0 );
+        REQUIRE( (table.PredictPosition(t) - result.r).norm() == 0.0 );
+        // Velocity is the derivative of the position fit.
+        REQUIRE( (result.v - expected.v).norm() < 1e-3 );
+    }
+}
+
+TEST_CASE( "test chebyshev fit throws if tolerance cannot be met",
+        "[Chebyshev]" ) {
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    const kin::Body &earth = Child(system->root(), "earth");
+    // Positions near 1.5e11 m cannot be represented to within 1e-9 m.
+    REQUIRE_THROWS_AS( kin::ChebyshevEphemeris(earth, 0.0, 1e6, 1e-9, 1e-3),
+                       std::runtime_error );
+    REQUIRE_THROWS_AS( kin::ChebyshevEphemeris(earth, 0.0, 1e6, 1.0, 1e-15),
+                       std::runtime_error );
+}
+
+TEST_CASE( "test chebyshev table rejects times outside span",
+        "[Chebyshev]" ) {
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    const kin::Body &earth = Child(system->root(), "earth");
+    const kin::ChebyshevEphemeris table(earth, 100.0, 1e6, 1.0, 1e-3);
+
+    REQUIRE( table.Covers(100.0) );
+    REQUIRE( table.Covers(1e6) );
+    REQUIRE_FALSE( table.Covers(99.0) );
+    REQUIRE_THROWS_AS( table.Predict(1e6 + 1.0), std::out_of_range );
+}
+
+TEST_CASE( "test chebyshev tables can be written and read", "[Chebyshev]" ) {
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    const kin::Body &earth = Child(system->root(), "earth");
+    const kin::Body &moon = Child(earth, "moon");
+    std::vector<kin::ChebyshevEphemeris> tables;
+    tables.emplace_back(earth, 0.0, 1e7, 1.0, 1e-3);
+    tables.emplace_back(moon, 0.0, 1e7, 1.0, 1e-3);
+
+    std::stringstream stream;
+    kin::WriteEphemerides(&stream, tables);
+    const std::vector<kin::ChebyshevEphemeris> read =
+        kin::ReadEphemerides(&stream);
+
+    REQUIRE( read.size() == 2 );
+    for (std::size_t i = 0; i < read.size(); ++i) {
+        REQUIRE( read[i].body_id() == tables[i].body_id() );
+        REQUIRE( read[i].degree() == tables[i].degree() );
+        REQUIRE( read[i].n_windows() == tables[i].n_windows() );
+        REQUIRE( read[i].error_bound() == tables[i].error_bound() );
+        REQUIRE( read[i].velocity_error_bound() ==
+                 tables[i].velocity_error_bound() );
+        for (const double t : {0.0, 12345.6, 5e6, 1e7}) {
+            REQUIRE( read[i].Predict(t).r == tables[i].Predict(t).r );
+            REQUIRE( read[i].Predict(t).v == tables[i].Predict(t).v );
+        }
+    }
+}
+
+TEST_CASE( "test reading invalid ephemeris data throws", "[Chebyshev]" ) {
+    std::stringstream not_ephemeris("not an ephemeris file");
+    REQUIRE_THROWS_AS(
+        kin::ReadEphemerides(&not_ephemeris), std::runtime_error );
+
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    std::stringstream stream;
+    kin::WriteEphemerides(&stream, {kin::ChebyshevEphemeris(
+        Child(system->root(), "earth"), 0.0, 1e6, 1.0, 1e-3)});
+    std::stringstream truncated(stream.str().substr(0, 60));
+    REQUIRE_THROWS_AS( kin::ReadEphemerides(&truncated), std::runtime_error );
+}
+
+static void PutUInt32(std::string *data, const std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        data->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+static void PutDouble(std::string *data, const double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        data->push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+/**
+ * Creates ephemeris data holding a single table with passed header
+ * values and window boundaries, and zeroed coefficients. No
+ * coefficients are written if degree exceeds kMaxDegree.
+ */
+static std::string CreateEphemerisData(const std::uint32_t degree,
+        const std::uint32_t n_windows, const std::vector<double> &bounds) {
+    std::string data("KINCHEB2");
+    PutUInt32(&data, 1);  // Number of tables.
+    PutUInt32(&data, 4);
+    data += "moon";
+    PutUInt32(&data, degree);
+    PutUInt32(&data, n_windows);
+    PutDouble(&data, 1.0);
+    PutDouble(&data, 1e-3);
+    for (const double bound : bounds) {
+        PutDouble(&data, bound);
+    }
+    if (degree <= kin::ChebyshevEphemeris::kMaxDegree) {
+        for (std::size_t i = 0; i < (bounds.size() - 1) * 3 * (degree + 1);
+                ++i) {
+            PutDouble(&data, 0.0);
+        }
+    }
+    return data;
+}
+
+TEST_CASE( "test reading corrupt ephemeris header throws", "[Chebyshev]" ) {
+    std::stringstream valid(CreateEphemerisData(2, 2, {0.0, 1.0, 2.0}));
+    REQUIRE( kin::ReadEphemerides(&valid).at(0).n_windows() == 2 );
+
+    // Window count whose coefficient count wraps in 32 bits.
+    std::stringstream huge(CreateEphemerisData(
+        2, 0xFFFFFFFF, {0.0, 1.0, 2.0}));
+    REQUIRE_THROWS_AS( kin::ReadEphemerides(&huge), std::runtime_error );
+    std::stringstream high_degree(CreateEphemerisData(
+        0x7FFFFFFF, 1, {0.0, 1.0}));
+    REQUIRE_THROWS_AS(
+        kin::ReadEphemerides(&high_degree), std::runtime_error );
+    std::stringstream unordered(CreateEphemerisData(2, 2, {0.0, 2.0, 1.0}));
+    REQUIRE_THROWS_AS( kin::ReadEphemerides(&unordered), std::runtime_error );
+    std::stringstream repeated(CreateEphemerisData(2, 2, {0.0, 1.0, 1.0}));
+    REQUIRE_THROWS_AS( kin::ReadEphemerides(&repeated), std::runtime_error );
+
+    // Table count far beyond the data present.
+    std::string many_tables("KINCHEB2");
+    PutUInt32(&many_tables, 0xFFFFFFFF);
+    std::stringstream many(many_tables);
+    REQUIRE_THROWS_AS( kin::ReadEphemerides(&many), std::runtime_error );
+}
+
+TEST_CASE( "test system loads ephemerides onto bodies", "[Chebyshev]" ) {
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    const kin::Body &earth = Child(system->root(), "earth");
+    const kin::Body &moon = Child(earth, "moon");
+    const double t = 2.5e6;
+    const kin::KinematicData expected = moon.PredictSystemKinematicData(t);
+
+    std::stringstream stream;
+    kin::WriteEphemerides(&stream, {
+        kin::ChebyshevEphemeris(moon, 0.0, 1e7, 1.0, 1e-3),
+        kin::ChebyshevEphemeris(earth, 0.0, 1e7, 1.0, 1e-3)});
+    REQUIRE( system->LoadEphemerides(&stream) == 2 );
+    REQUIRE( moon.system_ephemeris() != nullptr );
+    REQUIRE( earth.system_ephemeris() != nullptr );
+
+    // Predictions within span now come from tables.
+    REQUIRE( moon.PredictSystemKinematicData(t).r ==
+             moon.system_ephemeris()->Predict(t).r );
+    REQUIRE( moon.PredictSystemPosition(t) ==
+             moon.system_ephemeris()->PredictPosition(t) );
+    REQUIRE( (moon.PredictSystemPosition(t) - expected.r).norm() < 1.0 );
+    // Outside span, orbits are used.
+    REQUIRE( (moon.PredictSystemPosition(2e7) -
+              moon.PredictLocalPosition(2e7) -
+              earth.PredictLocalPosition(2e7)).norm() == 0.0 );
+}
+
+TEST_CASE( "test body rejects ephemeris of other body", "[Chebyshev]" ) {
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    kin::Body &earth = *system->root().children().at("earth");
+    const kin::Body &moon = Child(earth, "moon");
+    REQUIRE_THROWS_AS( earth.SetSystemEphemeris(
+        std::make_unique<kin::ChebyshevEphemeris>(
+            moon, 0.0, 1e6, 1.0, 1e-3)),
+        std::invalid_argument );
+}
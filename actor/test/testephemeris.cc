@@ -0,0 +1,159 @@
+#include "catch.hpp"
+
+#include "body.h"
+#include "const.h"
+#include "ephemeris.h"
+#include "orbit.h"
+#include "vector.h"
+
+
+TEST_CASE( "test ephemeris matches orbit prediction when e < 1",
+        "[OrbitEphemeris]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -402036457087.0);
+    kin::Vector v(7320.0, 11329.0, -0211.0);
+    kin::Orbit orbit(body, r, v);
+    const kin::OrbitEphemeris ephemeris(orbit);
+
+    for (int i = -3; i < 10; ++i) {
+        const double t = orbit.period() / 7 * i;
+        const kin::Orbit prediction = orbit.Predict(t);
+        const kin::KinematicData data = ephemeris.Predict(t);
+        const kin::Vector position = ephemeris.PredictPosition(t);
+        REQUIRE( (data.r - prediction.position()).norm() < r.norm() * 1e-9 );
+        REQUIRE( (data.v - prediction.velocity()).norm() < v.norm() * 1e-9 );
+        REQUIRE( (position - data.r).norm() < r.norm() * 1e-12 );
+    }
+}
+
+TEST_CASE( "test ephemeris matches orbit prediction when e > 1",
+        "[OrbitEphemeris]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    kin::Vector v(7320.0, 21329.0, -0211.0);
+    kin::Orbit orbit(body, r, v);
+    const kin::OrbitEphemeris ephemeris(orbit);
+
+    for (int i = 0; i < 5; ++i) {
+        const double t = 74942509.78053558 / 5 * i;
+        const kin::Orbit prediction = orbit.Predict(t);
+        const kin::KinematicData data = ephemeris.Predict(t);
+        REQUIRE( (data.r - prediction.position()).norm() < r.norm() * 1e-9 );
+        REQUIRE( (data.v - prediction.velocity()).norm() < v.norm() * 1e-9 );
+    }
+}
+
+TEST_CASE( "test ephemeris prediction 0s ahead matches orbit",
+        "[OrbitEphemeris]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    kin::Vector v(7320.0, 11329.0, -0211.0);
+    kin::Orbit orbit(body, r, v);
+    const kin::OrbitEphemeris ephemeris(orbit);
+
+    const kin::KinematicData data = ephemeris.Predict(0.0);
+    REQUIRE( data.r.x() == Approx(617244712358.0).epsilon(0.0001) );
+    REQUIRE( data.r.y() == Approx(-431694791368.0).epsilon(0.0001) );
+    REQUIRE( data.r.z() == Approx(-12036457087.0).epsilon(0.0001) );
+    REQUIRE( data.v.x() == Approx(7320.0).epsilon(0.0001) );
+    REQUIRE( data.v.y() == Approx(11329.0).epsilon(0.0001) );
+    REQUIRE( data.v.z() == Approx(-0211.0).epsilon(0.0001) );
+}
+
+TEST_CASE( "test body local prediction uses orbit", "[OrbitEphemeris]" ) {
+    kin::Body parent(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    kin::Vector v(7320.0, 11329.0, -0211.0);
+    kin::Orbit orbit(parent, r, v);
+    const kin::Body child(kin::G * 5.972e24, 10.0, "", &parent, &orbit);
+
+    const double t = 374942509.78053558 / 3;
+    const kin::Vector expected = orbit.Predict(t).position();
+    REQUIRE( (child.PredictLocalPosition(t) - expected).norm() <
+             expected.norm() * 1e-9 );
+}
+
+TEST_CASE( "test packed ephemeris predicts as original", "[OrbitEphemeris]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    const kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    for (const double speed_scale : {1.0, 3.0}) {  // e < 1, e > 1
+        const kin::Vector v =
+            kin::Vector(7320.0, 11329.0, -0211.0) * speed_scale;
+        const kin::OrbitEphemeris ephemeris(kin::Orbit(body, r, v));
+        const kin::OrbitEphemeris unpacked(ephemeris.Pack());
+        for (double t = 0.0; t < 4e8; t += 3.3e7) {
+            const kin::KinematicData expected = ephemeris.Predict(t);
+            const kin::KinematicData data = unpacked.Predict(t);
+            REQUIRE( (data.r - expected.r).norm() <
+                     expected.r.norm() * 1e-12 );
+            REQUIRE( (data.v - expected.v).norm() <
+                     expected.v.norm() * 1e-12 );
+        }
+    }
+}
+
+TEST_CASE( "test cursor prediction matches ephemeris", "[EphemerisCursor]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -402036457087.0);
+    kin::Vector v(7320.0, 11329.0, -0211.0);
+    const kin::Orbit orbit(body, r, v);
+    const kin::OrbitEphemeris ephemeris(orbit);
+    kin::EphemerisCursor cursor(ephemeris);
+
+    // Sweep forwards over two orbits, and then backwards.
+    const double period = orbit.period();
+    for (int i = -50; i < 200; ++i) {
+        const double t = period / 100 * i;
+        const kin::KinematicData expected = ephemeris.Predict(t);
+        const kin::KinematicData result = cursor.Predict(t);
+        REQUIRE( (result.r - expected.r).norm() < r.norm() * 1e-9 );
+        REQUIRE( (result.v - expected.v).norm() < v.norm() * 1e-9 );
+    }
+    for (int i = 200; i > -50; --i) {
+        const double t = period / 100 * i;
+        const kin::Vector expected = ephemeris.PredictPosition(t);
+        REQUIRE( (cursor.PredictPosition(t) - expected).norm() <
+                 r.norm() * 1e-9 );
+    }
+}
+
+TEST_CASE( "test cursor warm start needs about one iteration",
+        "[EphemerisCursor]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    kin::Vector v(2320.0, 17329.0, -2011.0);
+    const kin::Orbit orbit(body, r, v);
+    const kin::OrbitEphemeris ephemeris(orbit);
+    kin::EphemerisCursor cursor(ephemeris);
+
+    // Sample one orbit at animation rate; 1000 frames per orbit.
+    const int n_frames = 1000;
+    const double frame_t = orbit.period() / n_frames;
+    for (int i = 0; i < n_frames; ++i) {
+        cursor.Predict(frame_t * i);
+    }
+    const double warm_mean =
+        static_cast<double>(cursor.total_iterations()) / n_frames;
+
+    REQUIRE( cursor.n_evaluations() == n_frames );
+    REQUIRE( warm_mean <= 1.1 );
+}
+
+TEST_CASE( "test cursor handles hyperbolic orbits", "[EphemerisCursor]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    kin::Vector v(7320.0, 21329.0, -0211.0);
+    const kin::Orbit orbit(body, r, v);
+    const kin::OrbitEphemeris ephemeris(orbit);
+    kin::EphemerisCursor cursor(ephemeris);
+
+    for (int i = 0; i < 100; ++i) {
+        const double t = 374942509.78053558 / 50 * i;
+        const kin::KinematicData expected = ephemeris.Predict(t);
+        const kin::KinematicData result = cursor.Predict(t);
+        REQUIRE( (result.r - expected.r).norm() < expected.r.norm() * 1e-9 );
+        if (i > 0) {  // First solve is cold.
+            REQUIRE( cursor.last_iterations() <= 3 );
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#include <cmath>
+#include "catch.hpp"
+
+#include "integrator.h"
+#include "vector.h"
+
+
+static constexpr double kEarthGm = 3.986004418e14;
+
+/** Returns derivative of state of object orbiting the earth. */
+static kin::StateVector KeplerDerivative(
+        const double /*t*/, const kin::StateVector &y) {
+    const kin::Vector r = y.head<3>();
+    kin::StateVector derivative;
+    derivative << y.tail<3>(), r * (-kEarthGm / std::pow(r.norm(), 3));
+    return derivative;
+}
+
+
+TEST_CASE( "test integrator returns to start after one period",
+        "[Integrator]" ) {
+    const double r_mag = 7e6;
+    const double v_mag = std::sqrt(kEarthGm / r_mag);
+    const double period = 2 * M_PI * std::sqrt(std::pow(r_mag, 3) / kEarthGm);
+    const kin::StateVector y0 = kin::MakeStateVector(
+        kin::Vector(r_mag, 0.0, 0.0), kin::Vector(0.0, v_mag, 0.0));
+    const kin::DormandPrince integrator(KeplerDerivative, 1e-10, 1e-3, 1e-6);
+
+    kin::StateVector y = y0;
+    double t = 0.0;
+    double step = integrator.EstimateInitialStep(t, y, period);
+    int n_steps = 0;
+    while (t < period) {
+        const kin::DenseStep dense = integrator.Step(t, y, period - t, &step);
+        REQUIRE( dense.t0() == t );
+        REQUIRE( dense.t1() > t );
+        t = dense.t1();
+        y = dense.y1();
+        ++n_steps;
+    }
+    REQUIRE( t == Approx(period) );
+    REQUIRE( (y.head<3>() - y0.head<3>()).norm() < 1.0 );
+    REQUIRE( (y.tail<3>() - y0.tail<3>()).norm() < 1e-3 );
+    // Steps should be far longer than the shortest of the
+    // constant-acceleration maneuver segments.
+    REQUIRE( n_steps < 200 );
+}
+
+TEST_CASE( "test integrator dense output matches step ends",
+        "[Integrator]" ) {
+    const kin::StateVector y0 = kin::MakeStateVector(
+        kin::Vector(7e6, 1e5, 0.0), kin::Vector(100.0, 7500.0, 300.0));
+    const kin::DormandPrince integrator(KeplerDerivative, 1e-10, 1e-3, 1e-6);
+    double step = 300.0;
+    const kin::DenseStep first = integrator.Step(0.0, y0, 1e4, &step);
+    const kin::DenseStep second =
+        integrator.Step(first.t1(), first.y1(), 1e4, &step);
+
+    REQUIRE( (first.Interpolate(first.t0()) - y0).norm() < 1e-6 );
+    REQUIRE( (first.Interpolate(first.t1()) - first.y1()).norm() < 1e-6 );
+    // Interpolation part way through the second step should agree
+    // with a short step taken directly to the same time.
+    const double t = (second.t0() + second.t1()) / 2;
+    double direct_step = t - first.t1();
+    const kin::DenseStep direct = integrator.Step(
+        first.t1(), first.y1(), t - first.t1(), &direct_step);
+    REQUIRE( direct.t1() == Approx(t) );
+    const kin::StateVector difference = second.Interpolate(t) - direct.y1();
+    REQUIRE( difference.head<3>().norm() < 1e-2 );
+    REQUIRE( difference.tail<3>().norm() < 1e-5 );
+}
+
+TEST_CASE( "test integrator step does not exceed max step", "[Integrator]" ) {
+    const kin::StateVector y0 = kin::MakeStateVector(
+        kin::Vector(7e6, 0.0, 0.0), kin::Vector(0.0, 7546.0, 0.0));
+    const kin::DormandPrince integrator(KeplerDerivative, 1e-8, 1.0, 1e-3);
+    double step = 1e6;
+    const kin::DenseStep dense = integrator.Step(10.0, y0, 5.0, &step);
+
+    REQUIRE( dense.t0() == 10.0 );
+    REQUIRE( dense.t1() == 15.0 );
+}
@@ -0,0 +1,73 @@
+#include <cmath>
+
+#include "catch.hpp"
+
+#include "body.h"
+#include "const.h"
+#include "kepler.h"
+#include "orbit.h"
+#include "vector.h"
+
+
+// Error in anomaly implied by the residual of Kepler's equation.
+static double AnomalyError(const double e, const double M, const double E) {
+    if (e < 1.0) {
+        return std::fabs(E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
+    }
+    return std::fabs(e * std::sinh(E) - E - M) / (e * std::cosh(E) - 1.0);
+}
+
+TEST_CASE( "test elliptic kepler solve meets tolerance", "[Kepler]" ) {
+    for (int i = 0; i <= 100; ++i) {
+        const double e = 0.999 * i / 100;
+        for (int j = -100; j <= 100; ++j) {
+            const double M = kin::PI * j / 40;
+            int iterations;
+            const double physics =
+                kin::SolveKepler(e, M, kin::kPhysicsTolerance, &iterations);
+            REQUIRE( iterations <= 1 );
+            REQUIRE( AnomalyError(e, M, physics) < 1e-12 );
+            const double render =
+                kin::SolveKepler(e, M, kin::kRenderTolerance, &iterations);
+            REQUIRE( iterations <= 1 );
+            REQUIRE( std::fabs(render - physics) < 1e-7 );
+        }
+    }
+}
+
+TEST_CASE( "test hyperbolic kepler solve is bounded", "[Kepler]" ) {
+    // Includes near-parabolic cases.
+    for (const double e : {1.0 + 1e-8, 1.0 + 1e-4, 1.01, 1.5, 3.0, 30.0}) {
+        for (int j = -40; j <= 40; ++j) {
+            const double M =
+                std::copysign(std::pow(10.0, std::abs(j) / 8.0 - 4), j);
+            int iterations;
+            const double physics =
+                kin::SolveKepler(e, M, kin::kPhysicsTolerance, &iterations);
+            REQUIRE( iterations <= 6 );
+            REQUIRE( AnomalyError(e, M, physics) <
+                     1e-12 * std::fmax(1.0, std::fabs(physics)) );
+            const double render =
+                kin::SolveKepler(e, M, kin::kRenderTolerance, &iterations);
+            REQUIRE( iterations <= 6 );
+            REQUIRE( std::fabs(render - physics) <
+                     1e-7 * std::fmax(1.0, std::fabs(physics)) );
+        }
+    }
+}
+
+TEST_CASE( "test render tolerance prediction is close to physics",
+        "[Kepler]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -402036457087.0);
+    kin::Vector v(7320.0, 11329.0, -0211.0);
+    const kin::Orbit orbit(body, r, v);
+
+    for (int i = 0; i < 20; ++i) {
+        const double t = orbit.period() / 7 * i;
+        const kin::Vector physics = orbit.Predict(t).position();
+        const kin::Vector render =
+            orbit.Predict(t, kin::kRenderTolerance).position();
+        REQUIRE( (render - physics).norm() < physics.norm() * 1e-6 );
+    }
+}
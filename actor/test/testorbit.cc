@@ -669,3 +669,118 @@ TEST_CASE( "test orbit can be copied correctly", "[Orbit]" ) {
     REQUIRE( orbit_a.a == orbit_b.a );
     REQUIRE( orbit_a.t == orbit_b.t );
 }
+
+TEST_CASE( "test kinematic data matches position and velocity", "[Orbit]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -402036457087.0);
+    kin::Vector v(7320.0, 11329.0, -0211.0);
+    kin::Orbit orbit(body, r, v);
+    const kin::Orbit prediction = orbit.Predict(orbit.period() / 3);
+
+    const kin::KinematicData data = prediction.kinematic_data();
+    REQUIRE( data.r == prediction.position() );
+    REQUIRE( data.v == prediction.velocity() );
+}
+
+TEST_CASE( "test hyperbolic kinematic data can be recalculated", "[Orbit]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    kin::Vector v(7320.0, 21329.0, -0211.0);
+    kin::Orbit orbit(body, r, v);
+
+    const kin::KinematicData data = orbit.kinematic_data();
+    REQUIRE( data.r.x() == Approx(617244712358.0).epsilon(0.0001) );
+    REQUIRE( data.r.y() == Approx(-431694791368.0).epsilon(0.0001) );
+    REQUIRE( data.r.z() == Approx(-12036457087.0).epsilon(0.0001) );
+    REQUIRE( data.v.x() == Approx(7320.0).epsilon(0.0001) );
+    REQUIRE( data.v.y() == Approx(21329.0).epsilon(0.0001) );
+    REQUIRE( data.v.z() == Approx(-0211.0).epsilon(0.0001) );
+}
+
+TEST_CASE( "test orbit state prediction matches orbit prediction", "[Orbit]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -402036457087.0);
+    kin::Vector v(7320.0, 11329.0, -0211.0);
+    const kin::Orbit orbit(body, r, v);
+    const double t = orbit.period() * 2 / 3;
+
+    const kin::OrbitState state = orbit.PredictState(t);
+    const kin::Orbit prediction = orbit.Predict(t);
+    REQUIRE( state.true_anomaly == prediction.true_anomaly() );
+    REQUIRE( state.mean_anomaly == Approx(prediction.mean_anomaly()) );
+    REQUIRE( state.r == prediction.position() );
+    REQUIRE( state.v == prediction.velocity() );
+    // Original orbit should not have been advanced.
+    REQUIRE( orbit.position().x() == Approx(617244712358.0).epsilon(0.0001) );
+}
+
+TEST_CASE( "test hyperbolic orbit state prediction can be made", "[Orbit]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    kin::Vector v(7320.0, 21329.0, -0211.0);
+    const kin::Orbit orbit(body, r, v);
+    const double t = 74942509.78053558 / 10.0;
+
+    const kin::OrbitState state = orbit.PredictState(t);
+    const kin::Orbit prediction = orbit.Predict(t);
+    REQUIRE( state.eccentric_anomaly > orbit.eccentric_anomaly() );
+    REQUIRE( state.r == prediction.position() );
+    REQUIRE( state.v == prediction.velocity() );
+}
+
+TEST_CASE( "test parabolic orbit can be predicted", "[Orbit]" ) {
+    // e == 1 exactly; periapsis of 1, semi-latus rectum of 2.
+    const kin::Orbit orbit(2.0, kin::Vector(1, 0, 0), kin::Vector(0, 2, 0));
+    REQUIRE( orbit.eccentricity() == 1.0 );
+    REQUIRE( orbit.periapsis() == Approx(1.0) );
+    REQUIRE( orbit.semiparameter() == Approx(2.0) );
+    REQUIRE( orbit.mean_anomaly() == 0.0 );
+    REQUIRE( orbit.time_since_periapsis() == 0.0 );
+
+    // Barker's equation places true anomaly at 90 degrees after 4/3.
+    const kin::Orbit prediction = orbit.Predict(4.0 / 3.0);
+    REQUIRE( prediction.true_anomaly() == Approx(kin::PI / 2) );
+    REQUIRE( prediction.time_since_periapsis() == Approx(4.0 / 3.0) );
+    REQUIRE( prediction.position().x() == Approx(0.0).margin(1e-12) );
+    REQUIRE( prediction.position().y() == Approx(2.0) );
+    REQUIRE( prediction.velocity().x() == Approx(-1.0) );
+    REQUIRE( prediction.velocity().y() == Approx(1.0) );
+}
+
+TEST_CASE( "test parabolic orbit cannot be created from elements", "[Orbit]" ) {
+    REQUIRE_THROWS_AS(
+        kin::Orbit(2.0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0), std::invalid_argument);
+    REQUIRE_NOTHROW( kin::Orbit(2.0, 1.0, 0.5, 0.0, 0.0, 0.0, 0.0) );
+}
+
+TEST_CASE( "test universal prediction matches orbit prediction", "[Orbit]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -402036457087.0);
+    kin::Vector v(7320.0, 11329.0, -0211.0);
+    kin::Orbit orbit(body, r, v);
+    orbit.Step(orbit.period() / 5);
+    const double t = orbit.period() * 2 / 3;
+
+    const kin::OrbitState expected = orbit.PredictState(t);
+    const kin::KinematicData result = orbit.PredictKinematicData(t);
+    REQUIRE( (result.r - expected.r).norm() < r.norm() * 1e-9 );
+    REQUIRE( (result.v - expected.v).norm() < v.norm() * 1e-9 );
+}
+
+TEST_CASE( "Orbit from elements is positioned as orbit from vectors",
+           "[Orbit]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -402036457087.0);
+    kin::Vector v(7320.0, 11329.0, -2110.0);
+    kin::Orbit from_vectors(body, r, v);
+    kin::Orbit from_elements(body,
+        from_vectors.semi_major_axis(), from_vectors.eccentricity(),
+        from_vectors.inclination(),
+        from_vectors.longitude_of_ascending_node(),
+        from_vectors.argument_of_periapsis(),
+        from_vectors.true_anomaly());
+
+    const kin::KinematicData data = from_elements.kinematic_data();
+    REQUIRE( (data.r - r).norm() < r.norm() * 1e-9 );
+    REQUIRE( (data.v - v).norm() < v.norm() * 1e-9 );
+}
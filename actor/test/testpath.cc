@@ -1,7 +1,10 @@
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <utility>
 #include <string>
 #include <chrono>
+#include <vector>
 
 #include "catch.hpp"
 
@@ -12,9 +15,12 @@
 
 #include "system.h"
 #include "body.h"
+#include "cache.h"
 #include "orbit.h"
 #include "path.h"
 
+#include "fixtures.h"
+
 
 // FLIGHT PATH --------------------------------------------------------
 
@@ -124,7 +130,7 @@ TEST_CASE( "test add method adds maneuver to path", "[Path]" ) {
     path.Add(maneuver);
 
     REQUIRE( path.maneuvers_.size() == 1 );
-    REQUIRE( path.maneuvers_.begin()->second->t0() == half_orbit_t );
+    REQUIRE( path.maneuvers_[0]->t0() == half_orbit_t );
 }
 
 
@@ -175,6 +181,330 @@ TEST_CASE( "test path calc continues incomplete groups", "[Path]" ) {
 }
 
 
+TEST_CASE( "test path cache reuses arena memory", "[Path]" ) {
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", 3.986004418e14, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::Vector v(10.0, 7546.0, 20.0);
+    const kin::PerformanceData performance(3000.0, 20000.0);
+    kin::FlightPath path(system, r, v, 0.0);
+    path.Add(kin::Maneuver(
+        kin::Maneuver::kPrograde, 100.0, performance, 1000.0, 1000.0));
+    path.Add(kin::Maneuver(
+        kin::Maneuver::kNormal, 50.0, performance, 1000.0, 5000.0));
+    const kin::KinematicData expected = path.Predict(20000.0);
+    const std::size_t capacity = path.cache_arena().capacity();
+    const std::size_t bytes = path.cache_arena().bytes_allocated();
+    REQUIRE( path.cache_.groups.size() == 5 );
+    REQUIRE( bytes > 0 );
+
+    for (int i = 0; i < 3; ++i) {
+        path.ClearCache();
+        REQUIRE( path.cache_.groups.empty() );
+        REQUIRE( path.cache_arena().bytes_allocated() == 0 );
+        const kin::KinematicData result = path.Predict(20000.0);
+        REQUIRE( result.r == expected.r );
+        REQUIRE( result.v == expected.v );
+        REQUIRE( path.cache_arena().capacity() == capacity );
+        REQUIRE( path.cache_arena().bytes_allocated() == bytes );
+    }
+}
+
+
+TEST_CASE( "test editing maneuvers keeps path calculated before them",
+           "[Path]" ) {
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", 3.986004418e14, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::Vector v(10.0, 7546.0, 20.0);
+    const kin::PerformanceData performance(3000.0, 20000.0);
+    const kin::Maneuver first(
+        kin::Maneuver::kPrograde, 100.0, performance, 1000.0, 1000.0);
+    const kin::Maneuver second(
+        kin::Maneuver::kNormal, 50.0, performance, 1000.0, 5000.0);
+    const kin::Maneuver third(
+        kin::Maneuver::kRetrograde, 80.0, performance, 1000.0, 9000.0);
+    const kin::Maneuver edited_third(
+        kin::Maneuver::kRetrograde, 40.0, performance, 1000.0, 9000.0);
+    const double t = 20000.0;
+
+    // Finds position at t of a path calculated from scratch.
+    const auto expected = [&](std::vector<kin::Maneuver> maneuvers) {
+        kin::FlightPath path(system, r, v, 0.0);
+        for (const kin::Maneuver &maneuver : maneuvers) {
+            path.Add(maneuver);
+        }
+        return path.Predict(t).r;
+    };
+
+    kin::FlightPath path(system, r, v, 0.0);
+    path.Add(first);
+    path.Add(second);
+    // Adding a maneuver where the path is only partly calculated ends
+    // the unbounded ballistic group that will reach it.
+    path.Predict(7000.0);
+    path.Add(third);
+    REQUIRE( (path.Predict(t).r -
+              expected({first, second, third})).norm() < 1e-3 );
+
+    const std::size_t n_groups = path.cache_.groups.size();
+    // Groups preceding the one of the third maneuver are kept.
+    const std::size_t n_kept =
+        path.cache_.groups.UpperBound(third.t0()) - 1;
+    const std::vector<const kin::FlightPath::SegmentGroup*> kept(
+        path.cache_.groups.begin(), path.cache_.groups.begin() + n_kept);
+    const std::size_t n_resets = path.cache_arena().n_resets();
+
+    path.Remove(third);
+    REQUIRE( path.cache_.groups.size() == n_kept );
+    REQUIRE( path.cache_.status.end_t == third.t0() );
+    REQUIRE( path.cache_arena().n_resets() == n_resets );
+    REQUIRE( (path.Predict(t).r - expected({first, second})).norm() < 1e-3 );
+
+    path.Add(edited_third);
+    REQUIRE( path.cache_arena().n_resets() == n_resets );
+    REQUIRE( (path.Predict(t).r -
+              expected({first, second, edited_third})).norm() < 1e-3 );
+    REQUIRE( path.cache_.groups.size() == n_groups );
+    for (std::size_t i = 0; i < n_kept; ++i) {
+        REQUIRE( path.cache_.groups[i] == kept[i] );
+    }
+
+    path.ClearAfter(3000.0);
+    REQUIRE( path.cache_.status.end_t <= second.t0() );
+    REQUIRE( (path.Predict(t).r - expected({first})).norm() < 1e-3 );
+}
+
+TEST_CASE( "test cursor predicts as path", "[Path]" ) {
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", 3.986004418e14, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::Vector v(10.0, 7546.0, 20.0);
+    const kin::PerformanceData performance(3000.0, 20000.0);
+    kin::FlightPath path(system, r, v, 0.0);
+    path.Add(kin::Maneuver(
+        kin::Maneuver::kPrograde, 100.0, performance, 1000.0, 1000.0));
+    const kin::Maneuver second(
+        kin::Maneuver::kNormal, 50.0, performance, 1000.0, 5000.0);
+    path.Add(second);
+    kin::FlightPath::Cursor cursor(path);
+
+    // Times advance in small and large steps, and occasionally go back.
+    double t = 0.0;
+    for (int i = 0; i < 500; ++i) {
+        t = i % 50 == 49 ? t - 3000.0 : t + (i % 7 == 0 ? 400.0 : 13.0);
+        const kin::KinematicData expected = path.Predict(t);
+        const kin::KinematicData result = cursor.Predict(t);
+        REQUIRE( result.r == expected.r );
+        REQUIRE( result.v == expected.v );
+    }
+    REQUIRE( cursor.PredictOrbit(t).position() ==
+             path.PredictOrbit(t).position() );
+    REQUIRE_THROWS( cursor.Predict(-1.0) );
+
+    // Cursor remains usable after the path is changed.
+    path.Remove(second);
+    for (double edited_t = 4000.0; edited_t < 8000.0; edited_t += 100.0) {
+        REQUIRE( cursor.Predict(edited_t).r == path.Predict(edited_t).r );
+    }
+}
+
+TEST_CASE( "test range prediction matches single predictions", "[Path]" ) {
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", 3.986004418e14, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::Vector v(10.0, 7546.0, 20.0);
+    const kin::PerformanceData performance(3000.0, 20000.0);
+    const kin::Maneuver first(
+        kin::Maneuver::kPrograde, 100.0, performance, 1000.0, 1000.0);
+    kin::Maneuver integrated(
+        kin::Maneuver::kNormal, 50.0, performance, 1000.0, 5000.0);
+    integrated.set_propagation(kin::Maneuver::kIntegrated);
+    kin::FlightPath path(system, r, v, 0.0);
+    kin::FlightPath reference(system, r, v, 0.0);
+    for (kin::FlightPath *p : {&path, &reference}) {
+        p->Add(first);
+        p->Add(integrated);
+    }
+
+    std::vector<kin::Vector> range_r;
+    std::vector<kin::Vector> range_v;
+    const std::size_t n = 1000;
+    path.PredictRange(0.0, 30000.0, n, &range_r, &range_v);
+    REQUIRE( range_r.size() == n );
+    REQUIRE( range_v.size() == n );
+    for (std::size_t i = 0; i < n; ++i) {
+        const kin::KinematicData expected = reference.Predict(30000.0 * i / 999);
+        REQUIRE( (range_r[i] - expected.r).norm() < 1e-3 );
+        REQUIRE( (range_v[i] - expected.v).norm() < 1e-6 );
+    }
+
+    // Times out of order, and repeated, are also predicted.
+    const std::vector<double> times = {
+        20000.0, 100.0, 5500.0, 5500.0, 29000.0, 1200.0, 0.0};
+    std::vector<kin::Vector> at_r(times.size());
+    std::vector<kin::Vector> at_v(times.size());
+    path.PredictAt(times.data(), times.size(), at_r.data(), at_v.data());
+    for (std::size_t i = 0; i < times.size(); ++i) {
+        const kin::KinematicData expected = reference.Predict(times[i]);
+        REQUIRE( (at_r[i] - expected.r).norm() < 1e-3 );
+        REQUIRE( (at_v[i] - expected.v).norm() < 1e-6 );
+    }
+    const double invalid_time = -1.0;
+    REQUIRE_THROWS( path.PredictAt(
+        &invalid_time, 1, at_r.data(), at_v.data()) );
+    path.PredictRange(5.0, 5.0, 1, &range_r, &range_v);
+    REQUIRE( range_r[0] == path.Predict(5.0).r );
+}
+
+namespace {
+
+/**
+ * Checks that polyline of passed path is within tolerance of the path,
+ * sampling the path between each pair of vertices, and that vertices
+ * lie on the path.
+ */
+void CheckPolyline(const kin::FlightPath &path,
+                   const std::vector<kin::Vector> &vertices,
+                   const std::vector<double> &times, const double tolerance) {
+    REQUIRE( vertices.size() == times.size() );
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        REQUIRE( (path.Predict(times[i]).r - vertices[i]).norm() < 1e-3 );
+    }
+    for (std::size_t i = 1; i < vertices.size(); ++i) {
+        REQUIRE( times[i] > times[i - 1] );
+        const kin::Vector chord = vertices[i] - vertices[i - 1];
+        for (int j = 1; j < 8; ++j) {
+            const kin::Vector r = path.Predict(
+                times[i - 1] + (times[i] - times[i - 1]) * j / 8).r;
+            const double s = std::min(1.0, std::max(0.0,
+                (r - vertices[i - 1]).dot(chord) / chord.squaredNorm()));
+            const double error = (vertices[i - 1] + chord * s - r).norm();
+            REQUIRE( error < tolerance * 2 );
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE( "test tessellation concentrates vertices at periapsis",
+           "[Path]" ) {
+    const double gm = 3.986004418e14;
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", gm, 6.371e6));
+    // Periapsis of 7000km, eccentricity of 0.7.
+    const double rp = 7e6;
+    const double e = 0.7;
+    const double a = rp / (1 - e);
+    const kin::Vector r(rp, 0.0, 0.0);
+    const kin::Vector v(0.0, std::sqrt(gm * (1 + e) / rp), 0.0);
+    const kin::FlightPath path(system, r, v, 0.0);
+    const double period = 2 * kin::PI * std::sqrt(a * a * a / gm);
+
+    std::vector<kin::Vector> vertices;
+    std::vector<double> times;
+    const double tolerance = 1000.0;
+    path.Tessellate(0.0, period * 1.5, tolerance, &vertices, &times);
+    CheckPolyline(path, vertices, times, tolerance);
+    REQUIRE( times.front() == 0.0 );
+    REQUIRE( times.back() == Approx(period * 1.5) );
+
+    std::size_t n_near = 0;
+    for (const kin::Vector &vertex : vertices) {
+        n_near += vertex.norm() < a ? 1 : 0;
+    }
+    INFO( "vertices: " << vertices.size() << ", near periapsis: " << n_near );
+    REQUIRE( n_near > vertices.size() - n_near );
+    // Uniform sampling in time with the same spacing as near periapsis
+    // would take many more points.
+    const double periapsis_step = times[1] - times[0];
+    REQUIRE( vertices.size() * 3 < period * 1.5 / periapsis_step );
+
+    REQUIRE_THROWS( path.Tessellate(0.0, 1.0, 0.0, &vertices) );
+    REQUIRE_THROWS( path.Tessellate(2.0, 1.0, 1.0, &vertices) );
+}
+
+TEST_CASE( "test tessellation follows maneuvers and flybys", "[Path]" ) {
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", 3.986004418e14, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::PerformanceData performance(3000.0, 20000.0);
+    std::vector<kin::Vector> vertices;
+    std::vector<double> times;
+
+    // Hyperbolic path
+    const kin::FlightPath escape(
+        system, r, kin::Vector(0.0, 12000.0, 500.0), 0.0);
+    escape.Tessellate(0.0, 20000.0, 100.0, &vertices, &times);
+    CheckPolyline(escape, vertices, times, 100.0);
+
+    // Flyby of the moon; the polyline follows the path across the
+    // boundary of the moon's SOI, where its primary body changes.
+    const std::unique_ptr<kin::System> earth_moon = CreateEarthMoonSystem();
+    const kin::Body &earth = *earth_moon->root().children().at("earth");
+    const kin::Body &moon = *earth.children().at("moon");
+    const kin::KinematicData moon_data = moon.PredictSystemKinematicData(0.0);
+    const kin::Vector direction(0.6, 0.8, 0.0);
+    const kin::Vector flyby_r =
+        moon_data.r + direction * moon.sphere_of_influence() * 1.5;
+    const kin::Vector flyby_v = moon_data.v - direction * 1000.0 +
+        kin::Vector(-0.8, 0.6, 0.0) * 200.0;
+    const double entry_t = kin::FlightPath::BallisticSegment(
+        *earth_moon, flyby_r, flyby_v, 0.0).Calculate(1e7).end_t;
+    const kin::FlightPath flyby(*earth_moon, flyby_r, flyby_v, 0.0);
+    flyby.Tessellate(0.0, entry_t * 1.5, 100.0, &vertices, &times);
+    CheckPolyline(flyby, vertices, times, 100.0);
+    const std::size_t entry =
+        std::find(times.begin(), times.end(), entry_t) - times.begin();
+    REQUIRE( entry > 0 );
+    REQUIRE( entry + 1 < times.size() );
+    REQUIRE( &earth_moon->FindPrimaryInfluence(
+        vertices[entry - 1], times[entry - 1]) == &earth );
+    REQUIRE( &earth_moon->FindPrimaryInfluence(
+        vertices[entry + 1], times[entry + 1]) == &moon );
+
+    kin::FlightPath path(system, r, kin::Vector(10.0, 7546.0, 20.0), 0.0);
+    path.Add(kin::Maneuver(
+        kin::Maneuver::kPrograde, 500.0, performance, 1000.0, 1000.0));
+    kin::Maneuver integrated(
+        kin::Maneuver::kNormal, 300.0, performance, 1000.0, 5000.0);
+    integrated.set_propagation(kin::Maneuver::kIntegrated);
+    path.Add(integrated);
+    path.Tessellate(500.0, 15000.0, 100.0, &vertices, &times);
+    CheckPolyline(path, vertices, times, 100.0);
+    REQUIRE( times.front() == 500.0 );
+    REQUIRE( times.back() == 15000.0 );
+}
+
+TEST_CASE( "test repeated edits bound discarded groups", "[Path]" ) {
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", 3.986004418e14, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::Vector v(10.0, 7546.0, 20.0);
+    const kin::PerformanceData performance(3000.0, 20000.0);
+    kin::FlightPath path(system, r, v, 0.0);
+    for (int i = 0; i < 4; ++i) {
+        path.Add(kin::Maneuver(kin::Maneuver::kPrograde, 10.0, performance,
+                               1000.0, 1000.0 + 2000.0 * i));
+    }
+    const kin::Maneuver last(
+        kin::Maneuver::kRetrograde, 10.0, performance, 1000.0, 9000.0);
+    path.Add(last);
+    const std::size_t n_resets = path.cache_arena().n_resets();
+    for (int i = 0; i < 20; ++i) {
+        path.Predict(20000.0);
+        path.Remove(last);
+        path.Predict(20000.0);
+        path.Add(last);
+        REQUIRE( path.cache_.n_discarded_groups <=
+                 path.cache_.groups.size() );
+    }
+    // Cache is occasionally cleared, releasing discarded groups.
+    REQUIRE( path.cache_arena().n_resets() > n_resets );
+    REQUIRE( path.cache_arena().n_resets() < n_resets + 20 );
+}
+
+
 TEST_CASE( "test GetSegment returns different seg after maneuver", "[Path]" ) {
     std::unique_ptr<kin::Body> body =
         std::make_unique<kin::Body>(kin::G * 1.98891691172467e30, 10.0);
@@ -200,10 +530,10 @@ TEST_CASE( "test GetSegment returns different seg after maneuver", "[Path]" ) {
     const double t0 = maneuver.t0();
     const double t1 = maneuver.t1() + 1;
 
-    const kin::FlightPath::Segment &segment0 = path.GetSegment(t0);
-    const kin::FlightPath::Segment &segment1 = path.GetSegment(t1);
+    const kin::FlightPath::Segment segment0 = path.GetSegment(t0);
+    const kin::FlightPath::Segment segment1 = path.GetSegment(t1);
 
-    REQUIRE(segment0.r0_ != segment1.r0_);
+    REQUIRE(segment0.t0 != segment1.t0);
 }
 
 
@@ -261,6 +591,53 @@ TEST_CASE( "test orbit prediction has correct primary influence", "[Path]" ) {
     REQUIRE( orbit_prediction.body().id() == system.root().id() );
 }
 
+TEST_CASE( "test orbit prediction matches path prediction", "[Path]" ) {
+    std::unique_ptr<kin::Body> body =
+        std::make_unique<kin::Body>(kin::G * 1.98891691172467e30, 10.0);
+    const kin::System system(std::move(body));
+    const kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    const kin::Vector v(7320.0, 11329.0, -0211.0);
+    kin::FlightPath path(system, r, v, 0);
+    const double t = 374942509.78053558 / 3;
+
+    const kin::KinematicData prediction = path.Predict(t);
+    const kin::OrbitData orbit_data = path.PredictOrbit(t, &system.root());
+
+    REQUIRE( orbit_data.position() == prediction.r );
+    REQUIRE( orbit_data.velocity() == prediction.v );
+    // Elements are calculated on request, from the same state.
+    const kin::Vector orbit_r = orbit_data.orbit().position();
+    REQUIRE( (orbit_r - prediction.r).norm() < prediction.r.norm() * 1e-9 );
+    REQUIRE( orbit_data.orbit().semi_major_axis() ==
+             Approx(kin::Orbit(system.root(), r, v).semi_major_axis()) );
+}
+
+TEST_CASE( "test maneuver can be made on escape trajectory", "[Path]" ) {
+    std::unique_ptr<kin::Body> body =
+        std::make_unique<kin::Body>(kin::G * 1.98891691172467e30, 10.0);
+    const kin::System system(std::move(body));
+    const kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    const kin::Vector v(7320.0, 21329.0, -0211.0);  // e > 1
+    kin::FlightPath path(system, r, v, 0);
+
+    const kin::PerformanceData performance(3000.0, 20000.0);  // Ve, Thrust
+    const double dv = 2000.0;
+    const kin::Maneuver maneuver(
+            kin::Maneuver::kPrograde,  // Maneuver Type
+            dv,  // DV
+            performance,
+            150.0,  // m0
+            1000.0);  // t0
+    path.Add(maneuver);
+
+    const kin::KinematicData prediction0 = path.Predict(maneuver.t0());
+    const kin::KinematicData prediction1 = path.Predict(maneuver.t1());
+    REQUIRE( prediction1.v.norm() ==
+             Approx(prediction0.v.norm() + dv).epsilon(0.002) );
+    const kin::OrbitData orbit_data = path.PredictOrbit(maneuver.t1() - 1);
+    REQUIRE( orbit_data.orbit().eccentricity() > 1.0 );
+}
+
 TEST_CASE( "Test odd edge case with repeated calculation succeeds", "[Path]") {
 
     std::unique_ptr<kin::Body> body =
@@ -311,14 +688,16 @@ TEST_CASE( "Test r and v between segment groups match", "[Path]") {
             burn_start_t);  // t0
     path.Add(maneuver);
     
-    const kin::FlightPath::Segment &seg0 = path.GetSegment(0.0);
-    const kin::FlightPath::Segment &seg1 = path.GetSegment(burn_start_t);
+    const kin::FlightPath::Segment seg0 = path.GetSegment(0.0);
+    const kin::FlightPath::Segment seg1 = path.GetSegment(burn_start_t);
     
-    const kin::KinematicData seg0_end_data = seg0.Predict(burn_start_t);
-    const kin::KinematicData seg1_start_data = seg1.Predict(burn_start_t);
+    const kin::KinematicData seg0_end_data =
+        path.GetGroup(0.0).Predict(seg0, burn_start_t);
+    const kin::KinematicData seg1_start_data =
+        path.GetGroup(burn_start_t).Predict(seg1, burn_start_t);
 
     // Check that two different segments have been retrieved.
-    REQUIRE( &seg0 != &seg1 );
+    REQUIRE( seg0.kind != seg1.kind );
     
     // Check that velocities match
     REQUIRE( seg0_end_data.v.x() == seg1_start_data.v.x() );
@@ -352,14 +731,16 @@ TEST_CASE( "Test r and v between segment groups match2", "[Path]") {
 
     const double burn_end_t = maneuver.t1();
 
-    const kin::FlightPath::Segment &seg0 = path.GetSegment(burn_start_t);
-    const kin::FlightPath::Segment &seg1 = path.GetSegment(burn_end_t);
+    const kin::FlightPath::Segment seg0 = path.GetSegment(burn_start_t);
+    const kin::FlightPath::Segment seg1 = path.GetSegment(burn_end_t);
 
-    const kin::KinematicData seg0_end_data = seg0.Predict(burn_end_t - 0.00001);
-    const kin::KinematicData seg1_start_data = seg1.Predict(burn_end_t);
+    const kin::KinematicData seg0_end_data =
+        path.GetGroup(burn_start_t).Predict(seg0, burn_end_t - 0.00001);
+    const kin::KinematicData seg1_start_data =
+        path.GetGroup(burn_end_t).Predict(seg1, burn_end_t);
 
     // Check that two different segments have been retrieved.
-    REQUIRE( &seg0 != &seg1 );
+    REQUIRE( seg0.kind != seg1.kind );
 
     // Check that velocities match
     REQUIRE( seg0_end_data.v.x() ==
@@ -394,9 +775,9 @@ TEST_CASE( "Test r and v between segment groups match3", "[Path]") {
     path.GetSegment(burn_end_t); // Calculate.
 
     const kin::FlightPath::SegmentGroup &seg_group_0 =
-        *path.cache_.groups[burn_start_t];
+        *path.cache_.groups[path.cache_.groups.UpperBound(burn_start_t) - 1];
     const kin::FlightPath::SegmentGroup &seg_group_1 =
-        *path.cache_.groups[burn_end_t];
+        *path.cache_.groups[path.cache_.groups.UpperBound(burn_end_t) - 1];
 
     const double seg0_end_t = seg_group_0.calculation_status_.end_t;
     const double seg1_start_t = seg_group_1.t_;
@@ -429,10 +810,9 @@ TEST_CASE( "Test t between segments match up", "[Path]") {
 
     const double burn_end_t = maneuver.t1();
 
-    const kin::FlightPath::Segment &seg0 = path.GetSegment(burn_start_t);
-    const kin::FlightPath::Segment &seg1 = path.GetSegment(burn_end_t);
+    const kin::FlightPath::Segment seg1 = path.GetSegment(burn_end_t);
 
-    REQUIRE( seg1.t0_ == burn_end_t );
+    REQUIRE( seg1.t0 == burn_end_t );
 }
 
 TEST_CASE( "Test no abrupt velocity changes occur between segments", "[Path]") {
@@ -564,6 +944,139 @@ TEST_CASE( "test ballistic seg calc + predict agree", "[BallisticSegment]" ) {
 
 // BALLISTIC SEGMENT GROUP --------------------------------------------
 
+TEST_CASE( "test segment ends where orbit leaves primary SOI",
+        "[BallisticSegment]" ) {
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    const kin::Body &sun = system->root();
+    const kin::Body &earth = *sun.children().at("earth");
+    const kin::Body &moon = *earth.children().at("moon");
+    // Escape trajectory from low earth orbit, away from the moon.
+    const double t0 = 1000.0;
+    const kin::KinematicData earth_data = earth.PredictSystemKinematicData(t0);
+    const kin::Vector r = earth_data.r - moon.PredictLocalPosition(t0)
+        .normalized() * 7e6;
+    const kin::Vector v = earth_data.v +
+        moon.PredictLocalPosition(t0).cross(kin::Vector(0, 0, 1))
+        .normalized() * 12000.0;
+    const kin::FlightPath::BallisticSegment segment(*system, r, v, t0);
+    REQUIRE( &segment.primary_body_ == &earth );
+
+    const kin::FlightPath::CalculationStatus status = segment.Calculate(1e8);
+
+    REQUIRE( status.end_t < 1e8 );
+    const double distance =
+        (status.r - earth.PredictSystemPosition(status.end_t)).norm();
+    REQUIRE( distance == Approx(earth.sphere_of_influence()).margin(10.0) );
+    REQUIRE( distance >= earth.sphere_of_influence() );
+    REQUIRE( &system->FindPrimaryInfluence(status.r, status.end_t) == &sun );
+}
+
+TEST_CASE( "test segment ends where orbit enters peer SOI",
+        "[BallisticSegment]" ) {
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    const kin::Body &earth = *system->root().children().at("earth");
+    const kin::Body &moon = *earth.children().at("moon");
+    // Start outside the moon's SOI, heading towards it.
+    const double t0 = 0.0;
+    const kin::KinematicData moon_data = moon.PredictSystemKinematicData(t0);
+    const kin::Vector direction(0.6, 0.8, 0.0);
+    const kin::Vector r =
+        moon_data.r + direction * moon.sphere_of_influence() * 1.5;
+    const kin::Vector v = moon_data.v - direction * 1000.0;
+    const kin::FlightPath::BallisticSegment segment(*system, r, v, t0);
+    REQUIRE( &segment.primary_body_ == &earth );
+
+    const kin::FlightPath::CalculationStatus status = segment.Calculate(1e7);
+
+    REQUIRE( status.end_t < 1e7 );
+    const double distance =
+        (status.r - moon.PredictSystemPosition(status.end_t)).norm();
+    REQUIRE( distance == Approx(moon.sphere_of_influence()).margin(10.0) );
+    REQUIRE( &system->FindPrimaryInfluence(status.r, status.end_t) == &moon );
+}
+
+TEST_CASE( "test long coast needs few peer evaluations",
+        "[BallisticSegment]" ) {
+    const std::unique_ptr<kin::System> system = CreateEarthMoonSystem();
+    const kin::Body &earth = *system->root().children().at("earth");
+    // Low earth orbit; far from the moon for its entire duration.
+    const kin::KinematicData earth_data = earth.PredictSystemKinematicData(0);
+    const kin::Vector r = earth_data.r + kin::Vector(0.0, 0.0, 7e6);
+    const kin::Vector v = earth_data.v + kin::Vector(7546.0, 0.0, 0.0);
+    const kin::FlightPath::BallisticSegment segment(*system, r, v, 0.0);
+    REQUIRE( &segment.primary_body_ == &earth );
+
+    // Each step evaluates the moon at a new time, missing the cache.
+    kin::BodyStateCache &cache = kin::BodyStateCache::Local();
+    cache.Clear();
+    cache.ResetCounters();
+    const double month = 2.6e6;  // About 470 orbits.
+    const kin::FlightPath::CalculationStatus status = segment.Calculate(month);
+
+    REQUIRE( status.end_t > month );
+    REQUIRE( cache.misses() < 500 );
+}
+
+/**
+ * Creates a system with a gas giant as its root, orbited by moons
+ * with ids "io", "europa" and "ganymede".
+ */
+static std::unique_ptr<kin::System> CreateJovianSystem() {
+    auto jupiter = std::make_unique<kin::Body>(
+        "jupiter", 1.26686534e17, 6.9911e7);
+    const std::vector<std::pair<std::string, double> > moons = {
+        {"io", 4.217e8}, {"europa", 6.709e8}, {"ganymede", 1.0704e9}};
+    for (std::size_t i = 0; i < moons.size(); ++i) {
+        const double a = moons[i].second;
+        const double angle = 2.0 * i;
+        const kin::Vector radial(std::cos(angle), std::sin(angle), 0.0);
+        const kin::Vector prograde(-std::sin(angle), std::cos(angle), 0.0);
+        kin::Orbit orbit(*jupiter, radial * a,
+            (prograde + radial * 0.005) * std::sqrt(jupiter->gm() / a));
+        jupiter->AddChild(std::make_unique<kin::Body>(
+            moons[i].first, 5e12, 1.5e6, jupiter.get(), &orbit));
+    }
+    return std::make_unique<kin::System>(std::move(jupiter));
+}
+
+TEST_CASE( "test low orbit excludes unreachable peers",
+        "[BallisticSegment]" ) {
+    const std::unique_ptr<kin::System> system = CreateJovianSystem();
+    const kin::Vector r(1e8, 0.0, 0.0);
+    const kin::Vector v(0.0, 3.6e4, 1e3);
+    const kin::FlightPath::BallisticSegment segment(*system, r, v, 0.0);
+
+    REQUIRE( segment.orbit_.apoapsis() < 4e8 );
+    REQUIRE( segment.peers_.empty() );
+
+    // Segment has no end; calculation evaluates no moon.
+    kin::BodyStateCache &cache = kin::BodyStateCache::Local();
+    cache.Clear();
+    cache.ResetCounters();
+    const kin::FlightPath::CalculationStatus status = segment.Calculate(1e9);
+    REQUIRE( status.end_t > 1e9 );
+    REQUIRE( cache.misses() == 0 );
+}
+
+TEST_CASE( "test eccentric orbit keeps peers it may reach",
+        "[BallisticSegment]" ) {
+    const std::unique_ptr<kin::System> system = CreateJovianSystem();
+    // Periapsis inside io's orbit, apoapsis between europa and
+    // ganymede.
+    const kin::Vector r(3e8, 0.0, 0.0);
+    const kin::Vector v(0.0, 2.5e4, 0.0);
+    const kin::FlightPath::BallisticSegment segment(*system, r, v, 0.0);
+
+    REQUIRE( segment.orbit_.apoapsis() > 7e8 );
+    REQUIRE( segment.orbit_.apoapsis() < 1e9 );
+    std::vector<std::string> peer_ids;
+    for (const std::pair<const kin::Body*, double> &peer : segment.peers_) {
+        peer_ids.push_back(peer.first->id());
+    }
+    std::sort(peer_ids.begin(), peer_ids.end());
+    REQUIRE( peer_ids == std::vector<std::string>({"europa", "io"}) );
+}
+
 TEST_CASE( "test segment group can predict half orbit", "[BallisticSegment]" ) {
     std::unique_ptr<kin::Body> body =
         std::make_unique<kin::Body>(kin::G * 1.98891691172467e30, 10.0);
@@ -768,6 +1281,237 @@ TEST_CASE( "test maneuver group does not overrun", "[ManeuverSegmentGroup]") {
     REQUIRE( status.end_t == maneuver.t1() );
 }
 
+TEST_CASE( "test maneuver group rejects null maneuver",
+        "[ManeuverSegmentGroup]" ) {
+    std::unique_ptr<kin::Body> body =
+        std::make_unique<kin::Body>(kin::G * 1.98891691172467e30, 10.0);
+    const kin::System system(std::move(body));
+    const kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    const kin::Vector v(7320.0, 11329.0, -0211.0);
+    REQUIRE_THROWS_AS( kin::FlightPath::ManeuverSegmentGroup(
+        system, nullptr, r, v, 0.0), std::invalid_argument );
+}
+
+/**
+ * Integrates passed prograde maneuver about a lone body of passed gm
+ * with tight tolerances, returning the state at the maneuver's end.
+ */
+static kin::StateVector IntegrateReferenceManeuver(const double gm,
+        const kin::Maneuver &maneuver, const kin::Vector r,
+        const kin::Vector v) {
+    const kin::DormandPrince integrator(
+        [gm, &maneuver](const double t, const kin::StateVector &y) {
+            const kin::Vector r = y.head<3>();
+            const kin::Vector v = y.tail<3>();
+            const double m = maneuver.m0() -
+                (t - maneuver.t0()) * maneuver.performance().flow_rate();
+            kin::StateVector derivative;
+            derivative << v, r * (-gm / std::pow(r.norm(), 3)) +
+                v.normalized() * (maneuver.performance().thrust() / m);
+            return derivative;
+        }, 1e-13, 1e-6, 1e-9);
+    kin::StateVector y = kin::MakeStateVector(r, v);
+    double t = maneuver.t0();
+    double step = 1.0;
+    while (t < maneuver.t1()) {
+        const kin::DenseStep dense =
+            integrator.Step(t, y, maneuver.t1() - t, &step);
+        t = dense.t1();
+        y = dense.y1();
+    }
+    return y;
+}
+
+TEST_CASE( "test integrated maneuvers need fewer, more accurate segments",
+        "[ManeuverSegmentGroup]" ) {
+    const double gm = 3.986004418e14;
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", gm, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::Vector v(10.0, 7546.0, 20.0);
+    // A low thrust burn spanning many orbits, limited by orbital
+    // period, and a high thrust burn, limited by mass change.
+    const kin::PerformanceData ion(30000.0, 1.0);  // ve, thrust
+    const kin::PerformanceData chemical(3000.0, 20000.0);
+    for (const kin::Maneuver &maneuver : {
+            kin::Maneuver(kin::Maneuver::kPrograde, 100.0, ion, 1000.0, 0.0),
+            kin::Maneuver(
+                kin::Maneuver::kPrograde, 3000.0, chemical, 1000.0, 0.0)}) {
+        const kin::StateVector reference =
+            IntegrateReferenceManeuver(gm, maneuver, r, v);
+
+        kin::Maneuver constant = maneuver;
+        kin::FlightPath::ManeuverSegmentGroup constant_group(
+            system, &constant, r, v, 0.0);
+        const kin::FlightPath::CalculationStatus constant_status =
+            constant_group.Calculate(maneuver.t1());
+
+        kin::Maneuver integrated = maneuver;
+        integrated.set_propagation(kin::Maneuver::kIntegrated);
+        kin::FlightPath::ManeuverSegmentGroup integrated_group(
+            system, &integrated, r, v, 0.0);
+        const kin::FlightPath::CalculationStatus integrated_status =
+            integrated_group.Calculate(maneuver.t1());
+
+        const std::size_t constant_n = constant_group.segments().size();
+        const std::size_t integrated_n = integrated_group.segments().size();
+        const double constant_error =
+            (constant_status.r - kin::Vector(reference.head<3>())).norm();
+        const double integrated_error =
+            (integrated_status.r - kin::Vector(reference.head<3>())).norm();
+        INFO( "duration: " << maneuver.duration() << "s; " <<
+              "constant acceleration: " << constant_n << " segments, " <<
+              constant_error << "m error; " <<
+              "integrated: " << integrated_n << " segments, " <<
+              integrated_error << "m error" );
+        REQUIRE( integrated_status.end_t == maneuver.t1() );
+        REQUIRE( integrated_n * 2 < constant_n );
+        REQUIRE( integrated_error * 100 < constant_error );
+        // Prediction within the last segment agrees with its end.
+        const kin::KinematicData prediction =
+            integrated_group.Predict(maneuver.t1() - 1e-6);
+        REQUIRE( (prediction.r - integrated_status.r).norm() < 0.1 );
+    }
+}
+
+TEST_CASE( "test Encke maneuvers need fewer segments and steps",
+        "[ManeuverSegmentGroup]" ) {
+    const double gm = 3.986004418e14;
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", gm, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::Vector v(10.0, 7546.0, 20.0);
+    const kin::PerformanceData ion(30000.0, 1.0);  // ve, thrust
+    kin::Maneuver integrated(
+        kin::Maneuver::kPrograde, 100.0, ion, 1000.0, 0.0);
+    integrated.set_propagation(kin::Maneuver::kIntegrated);
+    kin::Maneuver encke = integrated;
+    encke.set_propagation(kin::Maneuver::kEncke);
+    const kin::StateVector reference =
+        IntegrateReferenceManeuver(gm, encke, r, v);
+
+    kin::FlightPath::ManeuverSegmentGroup integrated_group(
+        system, &integrated, r, v, 0.0);
+    const kin::FlightPath::CalculationStatus integrated_status =
+        integrated_group.Calculate(integrated.t1());
+    kin::FlightPath::ManeuverSegmentGroup encke_group(
+        system, &encke, r, v, 0.0);
+    // Calculated in parts, to exercise continuation of segments.
+    for (double t = 1e3; t < encke.t1(); t *= 3.0) {
+        encke_group.Calculate(t);
+    }
+    const kin::FlightPath::CalculationStatus encke_status =
+        encke_group.Calculate(encke.t1());
+
+    std::size_t encke_steps = 0;
+    for (const kin::FlightPath::Segment &segment : encke_group.segments()) {
+        encke_steps += segment.steps.n;
+    }
+    REQUIRE( encke_steps == encke_group.data_.steps.size() );
+    const std::size_t integrated_n = integrated_group.segments().size();
+    const std::size_t encke_n = encke_group.segments().size();
+    const double integrated_error =
+        (integrated_status.r - kin::Vector(reference.head<3>())).norm();
+    const double encke_error =
+        (encke_status.r - kin::Vector(reference.head<3>())).norm();
+    INFO( "integrated: " << integrated_n << " segments, " <<
+          integrated_error << "m error; " <<
+          "Encke: " << encke_n << " segments, " << encke_steps <<
+          " steps, " << encke_error << "m error" );
+    REQUIRE( encke_status.end_t == encke.t1() );
+    REQUIRE( encke_n * 10 < integrated_n );
+    REQUIRE( encke_steps * 2 < integrated_n );
+    REQUIRE( encke_error <= integrated_error );
+
+    // Each segment begins where the previous one ended.
+    for (std::size_t i = 1; i < encke_group.segments().size(); ++i) {
+        const double t = encke_group.segments().t(i);
+        const kin::KinematicData before = encke_group.Predict(t - 1e-6);
+        const kin::KinematicData after = encke_group.Predict(t);
+        REQUIRE( (before.r - after.r).norm() < 0.1 );
+        REQUIRE( (before.v - after.v).norm() < 1e-3 );
+    }
+}
+
+
+TEST_CASE( "test impulsive maneuvers are coasted with small error",
+        "[Path]" ) {
+    const double gm = 3.986004418e14;
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", gm, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::Vector v(10.0, 7546.0, 20.0);
+    const kin::PerformanceData chemical(3000.0, 20000.0);  // ve, thrust
+    kin::Maneuver maneuver(
+        kin::Maneuver::kPrograde, 100.0, chemical, 1000.0, 1000.0);
+    maneuver.set_propagation(kin::Maneuver::kIntegrated);
+    kin::FlightPath finite_path(system, r, v, 0.0);
+    finite_path.Add(maneuver);
+    maneuver.set_propagation(kin::Maneuver::kImpulsive);
+    kin::FlightPath impulsive_path(system, r, v, 0.0);
+    impulsive_path.Add(maneuver);
+
+    const double t = maneuver.t1() + 3000.0;
+    const kin::KinematicData finite = finite_path.Predict(t);
+    const kin::KinematicData impulsive = impulsive_path.Predict(t);
+    for (const auto &group : impulsive_path.cache_.groups) {
+        REQUIRE( dynamic_cast<const kin::FlightPath::BallisticSegmentGroup*>(
+            group) != nullptr );
+    }
+    REQUIRE( impulsive_path.cache_.groups.size() == 3 );
+    // The impulse is applied at the midpoint of the burn.
+    const kin::KinematicData before =
+        impulsive_path.Predict(maneuver.mid_t() - 1e-6);
+    const kin::KinematicData after = impulsive_path.Predict(maneuver.mid_t());
+    REQUIRE( (after.v - before.v).norm() == Approx(maneuver.dv()) );
+    REQUIRE( (impulsive.r - finite.r).norm() < 10.0 );
+
+    const kin::KinematicData error =
+        impulsive_path.FindImpulseError(maneuver);
+    INFO( "duration: " << maneuver.duration() << "s; impulse error: " <<
+          error.r.norm() << "m, " << error.v.norm() << "m/s" );
+    REQUIRE( error.r.norm() < 5.0 );
+    REQUIRE( error.v.norm() < 1e-2 );
+    // Error matches difference from the finite path at maneuver end.
+    const kin::KinematicData finite1 = finite_path.Predict(maneuver.t1());
+    const kin::KinematicData impulsive1 =
+        impulsive_path.Predict(maneuver.t1());
+    REQUIRE( (impulsive1.r - finite1.r - error.r).norm() < 0.1 );
+    REQUIRE_THROWS( finite_path.FindImpulseError(maneuver) );
+}
+
+TEST_CASE( "test impulse ratio selects only short maneuvers", "[Path]" ) {
+    const double gm = 3.986004418e14;
+    const kin::System system(
+        std::make_unique<kin::Body>("earth", gm, 6.371e6));
+    const kin::Vector r(7e6, 0.0, 0.0);
+    const kin::Vector v(10.0, 7546.0, 20.0);
+    const kin::PerformanceData chemical(3000.0, 20000.0);  // ve, thrust
+    const kin::PerformanceData ion(30000.0, 1.0);
+    kin::FlightPath path(system, r, v, 0.0);
+    const kin::Maneuver short_maneuver(
+        kin::Maneuver::kPrograde, 100.0, chemical, 1000.0, 1000.0);
+    const kin::Maneuver long_maneuver(
+        kin::Maneuver::kPrograde, 1.0, ion, 1000.0, 10000.0);
+    path.Add(short_maneuver);
+    path.Add(long_maneuver);
+    path.set_impulse_ratio(0.01);
+
+    path.Predict(long_maneuver.t1() + 1.0);
+    REQUIRE_NOTHROW( path.FindImpulseError(short_maneuver) );
+    REQUIRE_THROWS( path.FindImpulseError(long_maneuver) );
+    std::size_t maneuver_groups = 0;
+    for (const auto &group : path.cache_.groups) {
+        if (dynamic_cast<const kin::FlightPath::ManeuverSegmentGroup*>(
+                group) != nullptr) {
+            REQUIRE( group->maneuver()->t0() ==
+                     long_maneuver.t0() );
+            ++maneuver_groups;
+        }
+    }
+    REQUIRE( maneuver_groups == 1 );
+}
+
 
 // MANEUVER -----------------------------------------------------------
 
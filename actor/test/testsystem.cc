@@ -1,11 +1,84 @@
+#include <chrono>
+#include <cmath>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 #include "catch.hpp"
 #include "system.h"
 #include "body.h"
 #include "vector.h"
 #include "orbit.h"
 #include "path.h"
+#include "snapshot.h"
+
+#include "fixtures.h"
+
+
+/**
+ * Creates a system of a star with two planets, the first of which
+ * ("earth") has a moon.
+ */
+static std::unique_ptr<kin::System> CreatePlanetarySystem() {
+    std::unique_ptr<kin::Body> sun = CreateSunEarthMoon();
+    kin::Orbit mars_orbit(*sun,
+        kin::Vector(0.0, -2.279e11, 0.0), kin::Vector(24070.0, 0.0, 0.0));
+    sun->AddChild(std::make_unique<kin::Body>(
+        "mars", 4.282837e13, 3.3895e6, sun.get(), &mars_orbit));
+    return std::make_unique<kin::System>(std::move(sun));
+}
+
+/**
+ * Creates a system of a star with a gas giant ("jupiter") which has
+ * passed number of moons on nearly circular, non-intersecting orbits.
+ */
+static std::unique_ptr<kin::System> CreateMoonRichSystem(const int n_moons) {
+    auto sun = std::make_unique<kin::Body>("sun", 1.32712440018e20, 6.957e8);
+    kin::Orbit jupiter_orbit(*sun,
+        kin::Vector(7.785e11, 0.0, 0.0), kin::Vector(0.0, 13070.0, 300.0));
+    auto jupiter = std::make_unique<kin::Body>(
+        "jupiter", 1.26686534e17, 6.9911e7, sun.get(), &jupiter_orbit);
+    for (int i = 0; i < n_moons; ++i) {
+        const double a = 1e9 + 5e7 * i;
+        const double angle = 2.4 * i;
+        const double speed = std::sqrt(jupiter->gm() / a);
+        // Small radial and normal velocity components keep orbits
+        // slightly eccentric and inclined.
+        const kin::Vector radial(std::cos(angle), std::sin(angle), 0.0);
+        const kin::Vector prograde(-std::sin(angle), std::cos(angle), 0.0);
+        kin::Orbit moon_orbit(*jupiter, radial * a,
+            (prograde + radial * 0.01 + kin::Vector(0, 0, 1e-3 * i)) * speed);
+        jupiter->AddChild(std::make_unique<kin::Body>(
+            "moon" + std::to_string(i), 1e12, 1e5, jupiter.get(),
+            &moon_orbit));
+    }
+    sun->AddChild(std::move(jupiter));
+    return std::make_unique<kin::System>(std::move(sun));
+}
+
+/**
+ * Creates positions near each body of passed snapshot; some within
+ * its sphere of influence, and some outside.
+ */
+static std::vector<kin::Vector> CreatePositionsNearBodies(
+        const kin::SystemSnapshot &snapshot, const int n_per_body) {
+    std::vector<kin::Vector> positions;
+    for (kin::BodyIndex i = 0; i < snapshot.size(); ++i) {
+        const double soi = snapshot.hierarchy().sphere_of_influence(i);
+        const double scale = soi > 0.0 ? soi : 1e12;
+        for (int j = 0; j < n_per_body; ++j) {
+            // Offsets range from 0.025 to 1.975 times the SOI radius,
+            // never lying on its boundary, where rounding of the
+            // body's position decides the result.
+            const double distance = scale * 0.05 * (0.5 + j % 40);
+            const kin::Vector direction(
+                std::cos(j * 1.3), std::sin(j * 1.3), std::sin(j * 0.7));
+            positions.push_back(
+                snapshot.position(i) + direction.normalized() * distance);
+        }
+    }
+    return positions;
+}
 
 
 TEST_CASE( "test system root returns passed body", "[System]" ) {
@@ -35,4 +108,166 @@ TEST_CASE( "test system stores id if one passed", "[System]" ) {
     REQUIRE( system.id() == system_id );
 }
 
-// TODO: Add system position + velocity tests.
+TEST_CASE( "test primary influence descends through multiple levels",
+        "[System]" ) {
+    const std::unique_ptr<kin::System> system = CreatePlanetarySystem();
+    const kin::Body &earth = *system->root().children().at("earth");
+    const kin::Body &moon = *earth.children().at("moon");
+    const double t = 1e6;
+    const kin::Vector offset(1e6, 2e6, 0.0);
+
+    REQUIRE( &system->FindPrimaryInfluence(
+        moon.PredictSystemPosition(t) + offset, t) == &moon );
+    REQUIRE( &system->FindPrimaryInfluence(
+        earth.PredictSystemPosition(t) + offset, t) == &earth );
+    REQUIRE( &system->FindPrimaryInfluence(kin::Vector(0.0, 0.0, 1e12), t) ==
+             &system->root() );
+}
+
+TEST_CASE( "test system hierarchy is breadth first", "[System]" ) {
+    const std::unique_ptr<kin::System> system = CreatePlanetarySystem();
+    const kin::BodyHierarchy &hierarchy = system->hierarchy();
+
+    REQUIRE( hierarchy.size() == 4 );
+    REQUIRE( &hierarchy.body(0) == &system->root() );
+    REQUIRE( hierarchy.parent(0) == kin::kNoBodyIndex );
+    REQUIRE( hierarchy.sphere_of_influence(0) == -1.0 );
+    for (kin::BodyIndex i = 0; i < hierarchy.size(); ++i) {
+        const kin::Body &body = hierarchy.body(i);
+        REQUIRE( body.index() == i );
+        REQUIRE( hierarchy.Find(body.id()) == i );
+        REQUIRE( hierarchy.Contains(body) );
+        REQUIRE( hierarchy.n_children(i) == body.children().size() );
+        // Parents precede children, whose indices are contiguous.
+        if (i > 0) {
+            const kin::BodyIndex parent = hierarchy.parent(i);
+            REQUIRE( parent < i );
+            REQUIRE( &hierarchy.body(parent) == body.parent() );
+            REQUIRE( i >= hierarchy.first_child(parent) );
+            REQUIRE( i < hierarchy.children_end(parent) );
+            REQUIRE( hierarchy.sphere_of_influence(i) ==
+                     body.sphere_of_influence() );
+        }
+    }
+    REQUIRE_THROWS_AS( hierarchy.Find("pluto"), std::out_of_range );
+}
+
+TEST_CASE( "test system can be reindexed after bodies are added",
+        "[System]" ) {
+    const std::unique_ptr<kin::System> system = CreatePlanetarySystem();
+    kin::Body &mars = *system->root().children().at("mars");
+    kin::Orbit phobos_orbit(mars,
+        kin::Vector(9.376e6, 0.0, 0.0), kin::Vector(0.0, 2138.0, 0.0));
+    const kin::SystemSnapshot snapshot = system->Snapshot(0.0);
+    mars.AddChild(std::make_unique<kin::Body>(
+        "phobos", 7.087e5, 1.1e4, &mars, &phobos_orbit));
+    const kin::Body &phobos = *mars.children().at("phobos");
+    REQUIRE_FALSE( system->hierarchy().Contains("phobos") );
+    REQUIRE_FALSE( system->hierarchy().Contains(phobos) );
+    REQUIRE_THROWS_AS(
+        system->hierarchy().IndexOf(phobos), std::out_of_range );
+
+    system->Reindex();
+    REQUIRE( system->hierarchy().size() == 5 );
+    const kin::BodyIndex i = system->hierarchy().Find("phobos");
+    REQUIRE( system->hierarchy().IndexOf(phobos) == i );
+    REQUIRE( system->hierarchy().parent(i) == mars.index() );
+
+    // Snapshots of the previous hierarchy are rejected.
+    REQUIRE_FALSE( snapshot.IsCurrent() );
+    REQUIRE_THROWS_AS( snapshot.Find(phobos), std::logic_error );
+    REQUIRE_THROWS_AS( system->FindPrimaryInfluence(
+        snapshot, kin::Vector::Zero()), std::invalid_argument );
+    REQUIRE( system->Snapshot(0.0).IsCurrent() );
+}
+
+TEST_CASE( "test system snapshot matches body predictions", "[System]" ) {
+    const std::unique_ptr<kin::System> system = CreatePlanetarySystem();
+    const double t = 4.2e6;
+    const kin::SystemSnapshot snapshot = system->Snapshot(t);
+
+    REQUIRE( snapshot.t() == t );
+    REQUIRE( snapshot.size() == system->hierarchy().size() );
+    for (kin::BodyIndex i = 0; i < snapshot.size(); ++i) {
+        const kin::Body &body = snapshot.body(i);
+        const kin::KinematicData expected = body.PredictSystemKinematicData(t);
+        REQUIRE( snapshot.Find(body) == i );
+        // Snapshot orbits are evaluated in a batch, by a different
+        // solver, so agree to rounding rather than exactly.
+        REQUIRE( (snapshot.position(i) - expected.r).norm() <=
+                 expected.r.norm() * 1e-12 );
+        REQUIRE( (snapshot.velocity(i) - expected.v).norm() <=
+                 expected.v.norm() * 1e-12 );
+    }
+}
+
+TEST_CASE( "test snapshot primary influence matches per-body search",
+        "[System]" ) {
+    const std::unique_ptr<kin::System> system = CreatePlanetarySystem();
+    const double t = 8e5;
+    const kin::SystemSnapshot snapshot = system->Snapshot(t);
+    for (kin::BodyIndex i = 0; i < snapshot.size(); ++i) {
+        for (const double distance : {1e5, 1e7, 1e8, 1e9, 1e10}) {
+            const kin::Vector r =
+                snapshot.position(i) + kin::Vector(distance, 0.0, 0.0);
+            REQUIRE( &system->FindPrimaryInfluence(snapshot, r) ==
+                     &system->FindPrimaryInfluence(r, t) );
+        }
+    }
+}
+
+TEST_CASE( "test snapshot rejects body from other system", "[System]" ) {
+    const std::unique_ptr<kin::System> system = CreatePlanetarySystem();
+    const kin::Body other("other", 1.0, 1.0);
+    REQUIRE_THROWS_AS( system->Snapshot(0.0).Find(other), std::out_of_range );
+}
+
+TEST_CASE( "test batch primary influence matches per-position search",
+        "[System]" ) {
+    const std::unique_ptr<kin::System> system = CreateMoonRichSystem(60);
+    const double t = 3.3e6;
+    const std::vector<kin::Vector> positions =
+        CreatePositionsNearBodies(system->Snapshot(t), 20);
+
+    std::vector<const kin::Body*> influences;
+    system->FindPrimaryInfluences(positions, t, &influences);
+    REQUIRE( influences.size() == positions.size() );
+    std::size_t n_in_moons = 0;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        REQUIRE( influences[i] ==
+                 &system->FindPrimaryInfluence(positions[i], t) );
+        if (influences[i]->id().compare(0, 4, "moon") == 0) {
+            ++n_in_moons;
+        }
+    }
+    // Both outcomes should have been exercised.
+    REQUIRE( n_in_moons > 0 );
+    REQUIRE( n_in_moons < positions.size() );
+}
+
+TEST_CASE( "test batch primary influence is faster than per-position search",
+        "[System]" ) {
+    const std::unique_ptr<kin::System> system = CreateMoonRichSystem(60);
+    const double t = 1e7;
+    const std::vector<kin::Vector> positions =
+        CreatePositionsNearBodies(system->Snapshot(t), 40);
+
+    const std::chrono::steady_clock::time_point t0 =
+        std::chrono::steady_clock::now();
+    std::size_t n_loop_moons = 0;  // Prevents loop from being removed.
+    for (const kin::Vector &r : positions) {
+        n_loop_moons += system->FindPrimaryInfluence(r, t).HasParent();
+    }
+    const std::chrono::steady_clock::time_point t1 =
+        std::chrono::steady_clock::now();
+    std::vector<const kin::Body*> influences;
+    system->FindPrimaryInfluences(positions, t, &influences);
+    const std::chrono::steady_clock::time_point t2 =
+        std::chrono::steady_clock::now();
+
+    const std::chrono::duration<double> loop_s = t1 - t0;
+    const std::chrono::duration<double> batch_s = t2 - t1;
+    INFO( "loop: " << loop_s.count() << "s, batch: " << batch_s.count() << "s");
+    REQUIRE( n_loop_moons > 0 );
+    REQUIRE( batch_s.count() < loop_s.count() );
+}
@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "catch.hpp"
+
+#include "timeline.h"
+
+
+TEST_CASE( "test timeline upper bound matches std", "[Timeline]" ) {
+    kin::Timeline<int> timeline;
+    std::vector<double> times;
+    REQUIRE( timeline.UpperBound(0.0) == 0 );
+    for (int i = 0; i < 37; ++i) {
+        // Includes a repeated start time.
+        const double t = i < 20 ? i * 1.5 : (i - 1) * 1.5;
+        timeline.Append(t, i);
+        times.push_back(t);
+        for (double query = -1.0; query < t + 2.0; query += 0.25) {
+            const std::size_t expected = std::upper_bound(
+                times.begin(), times.end(), query) - times.begin();
+            REQUIRE( timeline.UpperBound(query) == expected );
+        }
+    }
+    REQUIRE( timeline.size() == 37 );
+    REQUIRE( timeline[timeline.UpperBound(4.6) - 1] == 3 );
+    REQUIRE( timeline.t(3) == 4.5 );
+}
+
+TEST_CASE( "test timeline rejects out of order values", "[Timeline]" ) {
+    kin::Timeline<std::unique_ptr<int> > timeline;
+    timeline.Append(1.0, std::make_unique<int>(1));
+    timeline.Append(1.0, std::make_unique<int>(2));
+    REQUIRE_THROWS( timeline.Append(0.5, std::make_unique<int>(3)) );
+    REQUIRE( timeline.size() == 2 );
+    REQUIRE( *timeline.back() == 2 );
+}
+
+TEST_CASE( "test timeline truncates and erases", "[Timeline]" ) {
+    kin::Timeline<int> timeline;
+    for (int i = 0; i < 5; ++i) {
+        timeline.Append(i, i);
+    }
+    timeline.Erase(1);
+    REQUIRE( timeline.size() == 4 );
+    REQUIRE( timeline[1] == 2 );
+    REQUIRE( timeline.t(1) == 2.0 );
+    REQUIRE( timeline.UpperBound(1.5) == 1 );
+
+    timeline.Truncate(timeline.UpperBound(2.5));
+    REQUIRE( timeline.size() == 2 );
+    REQUIRE( timeline.back() == 2 );
+    timeline.Append(2.5, 7);
+    REQUIRE( timeline.UpperBound(3.0) == 3 );
+
+    timeline.Clear();
+    REQUIRE( timeline.empty() );
+}
+
+TEST_CASE( "test timeline hinted upper bound matches unhinted", "[Timeline]" ) {
+    kin::Timeline<int> timeline;
+    for (int i = 0; i < 20; ++i) {
+        timeline.Append(i < 10 ? i : i - 1, i);
+    }
+    for (double t = -1.0; t < 21.0; t += 0.5) {
+        for (std::size_t hint = 0; hint <= timeline.size() + 1; ++hint) {
+            REQUIRE( timeline.UpperBound(t, hint) == timeline.UpperBound(t) );
+        }
+    }
+    REQUIRE( kin::Timeline<int>().UpperBound(1.0, 1) == 0 );
+}
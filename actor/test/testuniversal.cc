@@ -0,0 +1,155 @@
+#include <cmath>
+
+#include "catch.hpp"
+
+#include "body.h"
+#include "const.h"
+#include "orbit.h"
+#include "universal.h"
+#include "vector.h"
+
+
+TEST_CASE( "test stumpff functions are continuous at zero", "[Universal]" ) {
+    double c2, c3;
+    kin::Stumpff(0.0, &c2, &c3);
+    REQUIRE( c2 == Approx(0.5) );
+    REQUIRE( c3 == Approx(1.0 / 6.0) );
+    for (const double z : {1e-3, -1e-3}) {
+        double below2, below3, above2, above3;
+        kin::Stumpff(z * (1 - 1e-9), &below2, &below3);
+        kin::Stumpff(z * (1 + 1e-9), &above2, &above3);
+        REQUIRE( below2 == Approx(above2).epsilon(1e-12) );
+        REQUIRE( below3 == Approx(above3).epsilon(1e-12) );
+    }
+}
+
+TEST_CASE( "test universal prediction matches elliptic orbit",
+        "[Universal]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -402036457087.0);
+    kin::Vector v(7320.0, 11329.0, -0211.0);
+    const kin::Orbit orbit(body, r, v);
+    const kin::UniversalPropagator propagator(body.gm(), r, v);
+
+    for (int i = -20; i <= 20; ++i) {
+        const double t = orbit.period() * i / 7.3;
+        const kin::OrbitState expected = orbit.PredictState(t);
+        const kin::KinematicData result = propagator.Predict(t);
+        REQUIRE( (result.r - expected.r).norm() < r.norm() * 1e-9 );
+        REQUIRE( (result.v - expected.v).norm() < v.norm() * 1e-9 );
+    }
+}
+
+TEST_CASE( "test universal prediction matches hyperbolic orbit",
+        "[Universal]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    kin::Vector r(617244712358.0, -431694791368.0, -12036457087.0);
+    kin::Vector v(7320.0, 21329.0, -0211.0);
+    const kin::Orbit orbit(body, r, v);
+    const kin::UniversalPropagator propagator(body.gm(), r, v);
+
+    for (int i = -10; i <= 10; ++i) {
+        const double t = 374942509.78053558 * i;
+        const kin::OrbitState expected = orbit.PredictState(t);
+        const kin::KinematicData result = propagator.Predict(t);
+        REQUIRE( (result.r - expected.r).norm() <
+                 expected.r.norm() * 1e-9 );
+        REQUIRE( (result.v - expected.v).norm() <
+                 expected.v.norm() * 1e-9 );
+    }
+}
+
+TEST_CASE( "test universal prediction of parabolic orbit", "[Universal]" ) {
+    // Periapsis of 1 and semi-latus rectum of 2. Barker's equation
+    // places the true anomaly at 90 degrees after 4/3 time units.
+    const kin::UniversalPropagator propagator(
+        2.0, kin::Vector(1.0, 0.0, 0.0), kin::Vector(0.0, 2.0, 0.0));
+    REQUIRE( propagator.alpha() == 0.0 );
+
+    const kin::KinematicData result = propagator.Predict(4.0 / 3.0);
+    REQUIRE( result.r.x() == Approx(0.0).margin(1e-12) );
+    REQUIRE( result.r.y() == Approx(2.0) );
+    REQUIRE( result.v.x() == Approx(-1.0) );
+    REQUIRE( result.v.y() == Approx(1.0) );
+
+    const kin::KinematicData before = propagator.Predict(-4.0 / 3.0);
+    REQUIRE( before.r.x() == Approx(0.0).margin(1e-12) );
+    REQUIRE( before.r.y() == Approx(-2.0) );
+}
+
+TEST_CASE( "test universal prediction is continuous across e == 1",
+        "[Universal]" ) {
+    const double u = 2.0;
+    const kin::Vector r(1.0, 0.0, 0.0);
+    const kin::UniversalPropagator parabolic(
+        u, r, kin::Vector(0.0, 2.0, 0.0));
+    const kin::UniversalPropagator elliptic(
+        u, r, kin::Vector(0.0, 2.0 - 1e-9, 0.0));
+    const kin::UniversalPropagator hyperbolic(
+        u, r, kin::Vector(0.0, 2.0 + 1e-9, 0.0));
+    REQUIRE( elliptic.alpha() > 0.0 );
+    REQUIRE( hyperbolic.alpha() < 0.0 );
+
+    for (const double t : {-100.0, -1.0, 0.1, 10.0, 1000.0}) {
+        const kin::Vector expected = parabolic.Predict(t).r;
+        // Divergence after time t grows roughly as t * dv.
+        const double margin = 1e-6 * (1.0 + std::fabs(t));
+        REQUIRE( (elliptic.Predict(t).r - expected).norm() <
+                 expected.norm() * margin );
+        REQUIRE( (hyperbolic.Predict(t).r - expected).norm() <
+                 expected.norm() * margin );
+    }
+}
+
+TEST_CASE( "test universal solve is bounded for mixed orbits",
+        "[Universal]" ) {
+    const double u = 1.0;
+    const kin::Vector r(1.0, 0.0, 0.0);
+    for (int i = 0; i <= 40; ++i) {
+        // Periapsis speeds from circular to e == 3.
+        const kin::Vector v(0.0, std::sqrt(1.0 + 3.0 * i / 40), 0.1);
+        const kin::UniversalPropagator propagator(u, r, v);
+        const double energy = v.squaredNorm() / 2 - u;
+        for (int j = -12; j <= 12; ++j) {
+            const double t =
+                std::copysign(std::pow(10.0, std::abs(j) / 3.0), j);
+            int iterations;
+            const kin::KinematicData result =
+                propagator.Predict(t, kin::kPhysicsTolerance, &iterations);
+            REQUIRE( iterations <= 6 );
+            const double result_energy =
+                result.v.squaredNorm() / 2 - u / result.r.norm();
+            REQUIRE( result_energy == Approx(energy).margin(1e-9) );
+            REQUIRE( (result.r.cross(result.v) - r.cross(v)).norm() < 1e-9 );
+        }
+    }
+}
+
+TEST_CASE( "test universal prediction at half period", "[Universal]" ) {
+    // Circular orbit with a period of exactly TAU; half a period lies
+    // on the rounding boundary used when removing whole periods.
+    const kin::UniversalPropagator propagator(
+        1.0, kin::Vector(1.0, 0.0, 0.0), kin::Vector(0.0, 1.0, 0.0));
+    for (const double t : {kin::PI, -kin::PI, 3 * kin::PI}) {
+        const kin::KinematicData result = propagator.Predict(t);
+        REQUIRE( (result.r - kin::Vector(-1.0, 0.0, 0.0)).norm() < 1e-9 );
+        REQUIRE( (result.v - kin::Vector(0.0, -1.0, 0.0)).norm() < 1e-9 );
+    }
+}
+
+TEST_CASE( "test characteristic period matches orbit", "[Universal]" ) {
+    kin::Body body(kin::G * 1.98891691172467e30, 10.0);
+    const kin::Vector r(617244712358.0, -431694791368.0, -402036457087.0);
+    const kin::Vector v(7320.0, 11329.0, -0211.0);
+    const kin::Orbit orbit(body, r, v);
+    REQUIRE( kin::FindCharacteristicPeriod(body.gm(), r, v) ==
+             Approx(orbit.period()) );
+
+    const kin::Vector hyperbolic_v(7320.0, 21329.0, -0211.0);
+    const kin::Orbit hyperbolic(body, r, hyperbolic_v);
+    REQUIRE( kin::FindCharacteristicPeriod(body.gm(), r, hyperbolic_v) ==
+             Approx(kin::TAU / hyperbolic.mean_motion()) );
+
+    REQUIRE( std::isinf(kin::FindCharacteristicPeriod(
+        2.0, kin::Vector(1.0, 0.0, 0.0), kin::Vector(0.0, 2.0, 0.0))) );
+}
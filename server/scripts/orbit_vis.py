@@ -53,14 +53,10 @@ def position_plot() -> None:
     path_.add(maneuver)
 
     # Get points to plot
-    x_pts = []
-    y_pts = []
-
-    for i in range(N_POINTS):
-        t = period0 / N_POINTS * i
-        kinematic_data: path.PyKinematicData = path_.predict(t)
-        x_pts.append(kinematic_data.r.x)
-        y_pts.append(kinematic_data.r.y)
+    r_pts, _ = path_.predict_range(
+        0, period0 / N_POINTS * (N_POINTS - 1), N_POINTS)
+    x_pts = r_pts[0::3]
+    y_pts = r_pts[1::3]
 
     burn_start_prediction = path_.predict(burn_start_t)
     burn_start_pos = burn_start_prediction.r
@@ -1,4 +1,5 @@
 cimport libcpp.memory as mem
+from libcpp.vector cimport vector
 cimport cython as cy
 
 from vector cimport Vector, PyVector
@@ -35,6 +36,8 @@ cdef extern from "path.h" namespace "kin" nogil:
     cppclass OrbitData:
         const Orbit &orbit() const
         const Body &body() const
+        const Vector &position() const
+        const Vector &velocity() const
 
 
     cppclass Maneuver:
@@ -77,6 +80,18 @@ cdef extern from "path.h" namespace "kin" nogil:
 
         # Gets KinematicData for passed point in time since t0 */
         KinematicData Predict(const double time) const
+        void PredictRange(
+            const double t0,
+            const double t1,
+            const size_t n,
+            vector[Vector] *r,
+            vector[Vector] *v) const except +
+        void Tessellate(
+            const double t0,
+            const double t1,
+            const double tolerance,
+            vector[Vector] *vertices,
+            vector[double] *times) const except +
         OrbitData PredictOrbit(const double time) const
         OrbitData PredictOrbit(const double time, const Body *body) const
         const Maneuver *FindManeuver(const double t) const
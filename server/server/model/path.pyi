@@ -1,3 +1,4 @@
+import array
 from enum import Enum
 import typing as ty
 
@@ -66,6 +67,10 @@ class PyFlightPath:
     ) -> None: ...
 
     def predict(self, time: float) -> PyKinematicData: ...
+    def predict_range(self, t0: float, t1: float, n: int) -> \
+            ty.Tuple[array.array, array.array]: ...
+    def tessellate(self, t0: float, t1: float, tolerance: float) -> \
+            ty.Tuple[array.array, array.array]: ...
     def predict_orbit(self, time: float, body: PyBody = None) -> PyOrbitData:...
     def find_maneuver(self, t: float) -> PyManeuver: ...
     def find_next_maneuver(self, t: float) -> PyManeuver: ...
@@ -4,7 +4,9 @@ functions, structs, and classes of actor/src/path.h.
 """
 
 from enum import Enum
+import array
 cimport cython as cy
+from cpython cimport array
 from libcpp.cast cimport const_cast
 
 
@@ -83,6 +85,14 @@ cdef class PyOrbitData:
             self._body = PyBody.wrap(<Body *>(&self._data.get().body()))
         return self._body
 
+    @property
+    def r(self) -> PyVector:
+        return PyVector.cp(self._data.get().position())
+
+    @property
+    def v(self) -> PyVector:
+        return PyVector.cp(self._data.get().velocity())
+
 
 class ManeuverTypes(Enum):
     Prograde = ManeuverType.kPrograde
@@ -198,6 +208,49 @@ cdef class PyFlightPath:
     cpdef PyKinematicData predict(self, double time):
         return PyKinematicData.cp(self._path.Predict(time))
 
+    def predict_range(self, double t0, double t1, size_t n):
+        """
+        Predicts path at n times evenly spaced from t0 to t1 inclusive.
+        Returns positions and velocities as flat arrays of doubles,
+        holding the x, y and z components of each in turn.
+        """
+        cdef vector[Vector] r
+        cdef vector[Vector] v
+        self._path.PredictRange(t0, t1, n, &r, &v)
+        cdef array.array r_out = array.clone(array.array('d'), 3 * n, False)
+        cdef array.array v_out = array.clone(array.array('d'), 3 * n, False)
+        cdef size_t i
+        for i in range(n):
+            r_out.data.as_doubles[3 * i] = r[i].x()
+            r_out.data.as_doubles[3 * i + 1] = r[i].y()
+            r_out.data.as_doubles[3 * i + 2] = r[i].z()
+            v_out.data.as_doubles[3 * i] = v[i].x()
+            v_out.data.as_doubles[3 * i + 1] = v[i].y()
+            v_out.data.as_doubles[3 * i + 2] = v[i].z()
+        return r_out, v_out
+
+    def tessellate(self, double t0, double t1, double tolerance):
+        """
+        Finds polyline following path from t0 to t1, within tolerance
+        of the path. Returns vertices as a flat array of doubles,
+        holding the x, y and z components of each in turn, and an
+        array of the time of each vertex.
+        """
+        cdef vector[Vector] vertices
+        cdef vector[double] times
+        self._path.Tessellate(t0, t1, tolerance, &vertices, &times)
+        cdef size_t n = vertices.size()
+        cdef array.array vertices_out = array.clone(
+            array.array('d'), 3 * n, False)
+        cdef array.array times_out = array.clone(array.array('d'), n, False)
+        cdef size_t i
+        for i in range(n):
+            vertices_out.data.as_doubles[3 * i] = vertices[i].x()
+            vertices_out.data.as_doubles[3 * i + 1] = vertices[i].y()
+            vertices_out.data.as_doubles[3 * i + 2] = vertices[i].z()
+            times_out.data.as_doubles[i] = times[i]
+        return vertices_out, times_out
+
     cpdef PyOrbitData predict_orbit(self, double time, PyBody body = None):
         if body:
             return PyOrbitData.cp(self._path.PredictOrbit(time, body.get()))
@@ -187,3 +187,36 @@ class TestFlightPath(TestCase):
         self.assertAlmostEqual(seg0_end_data.v.x, seg1_start_data.v.x, 6)
         self.assertAlmostEqual(seg0_end_data.v.y, seg1_start_data.v.y, 6)
         self.assertAlmostEqual(seg0_end_data.v.z, seg1_start_data.v.z, 6)
+
+    def test_predict_range_matches_predict(self):
+        body = PyBody(gm=const.G * 1.98891691172467e30, r=10)
+        system = PySystem(root=body)
+        r = PyVector(617244712358.0, -431694791368.0, -12036457087.0)
+        v = PyVector(7320.0, 11329.0, -0211.0)
+        path_ = path.PyFlightPath(system, r, v, 0)
+
+        period0 = 374942509.78053558
+        r_pts, v_pts = path_.predict_range(0, period0, 11)
+        self.assertEqual(33, len(r_pts))
+        self.assertEqual(33, len(v_pts))
+        for i in range(11):
+            prediction = path_.predict(period0 / 10 * i)
+            self.assertAlmostEqual(prediction.r.x, r_pts[3 * i], 0)
+            self.assertAlmostEqual(prediction.r.y, r_pts[3 * i + 1], 0)
+            self.assertAlmostEqual(prediction.v.z, v_pts[3 * i + 2], 6)
+
+    def test_tessellate_vertices_lie_on_path(self):
+        body = PyBody(gm=const.G * 1.98891691172467e30, r=10)
+        system = PySystem(root=body)
+        r = PyVector(617244712358.0, -431694791368.0, -12036457087.0)
+        v = PyVector(7320.0, 11329.0, -0211.0)
+        path_ = path.PyFlightPath(system, r, v, 0)
+
+        period0 = 374942509.78053558
+        vertices, times = path_.tessellate(0, period0, 1e8)
+        self.assertEqual(3 * len(times), len(vertices))
+        self.assertLess(10, len(times))
+        for i in range(len(times)):
+            prediction = path_.predict(times[i])
+            self.assertAlmostEqual(prediction.r.x, vertices[3 * i], 0)
+            self.assertAlmostEqual(prediction.r.z, vertices[3 * i + 2], 0)